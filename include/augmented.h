@@ -0,0 +1,197 @@
+#ifndef BINARY_SEARCH_TREES_AUGMENTED_H
+#define BINARY_SEARCH_TREES_AUGMENTED_H
+
+#include "avl.h"
+#include "scapegoat.h"
+#include <algorithm>
+#include <concepts>
+#include <limits>
+
+// An associative summary over values: combine(identity(), x) == combine(x, identity()) == x. Summaries are
+// combined in key order, so combine does not need to be commutative.
+template <typename M, typename T>
+concept Monoid = requires(const T &value, const typename M::value_type &a, const typename M::value_type &b) {
+    { M::identity() } -> std::convertible_to<typename M::value_type>;
+    { M::lift(value) } -> std::convertible_to<typename M::value_type>;
+    { M::combine(a, b) } -> std::convertible_to<typename M::value_type>;
+};
+
+template <typename T>
+struct SumMonoid {
+    using value_type = T;
+    static T identity() { return T(); }
+    static T lift(const T &value) { return value; }
+    static T combine(const T &a, const T &b) { return a + b; }
+};
+
+template <typename T>
+struct MinMonoid {
+    using value_type = T;
+    static T identity() { return std::numeric_limits<T>::max(); }
+    static T lift(const T &value) { return value; }
+    static T combine(const T &a, const T &b) { return std::min(a, b); }
+};
+
+template <typename T>
+struct MaxMonoid {
+    using value_type = T;
+    static T identity() { return std::numeric_limits<T>::lowest(); }
+    static T lift(const T &value) { return value; }
+    static T combine(const T &a, const T &b) { return std::max(a, b); }
+};
+
+template <typename T>
+struct CountMonoid {
+    using value_type = size_t;
+    static size_t identity() { return 0; }
+    static size_t lift(const T &) { return 1; }
+    static size_t combine(size_t a, size_t b) { return a + b; }
+};
+
+template <typename Tree>
+concept Augmentable = std::derived_from<Tree, AVLTree<typename Tree::value_type, typename Tree::allocator_type>> ||
+                      std::derived_from<Tree, ScapegoatTree<typename Tree::value_type, typename Tree::allocator_type>>;
+
+// Keeps Monoid's summary of every subtree next to the node vector. AVL trees refresh it through the height
+// updates of insert, remove and rotations, scapegoat trees along insert and remove paths and bottom-up over every
+// rebuilt subtree. aggregate(lo, hi) then folds the values in [lo, hi] along two root paths in O(log n).
+template <typename Tree, typename Monoid>
+requires Augmentable<Tree> && ::Monoid<Monoid, typename Tree::value_type>
+class AugmentedTree : public Tree {
+public:
+    using summary_type = typename Monoid::value_type;
+    using value_type = typename Tree::value_type;
+
+    // Takes the engine's own constructor arguments; a tree filled by them is summarised once afterwards. Copies and
+    // moves of an AugmentedTree carry the summaries over instead.
+    template <typename... Args>
+    requires (!(sizeof...(Args) == 1 && (std::derived_from<std::remove_cvref_t<Args>, AugmentedTree> && ...)))
+    explicit AugmentedTree(Args &&...args);
+
+    [[nodiscard]] summary_type aggregate() const;
+    [[nodiscard]] summary_type aggregate(const value_type &low, const value_type &high) const;
+
+protected:
+    using Node = typename BinarySearchTree<value_type, typename Tree::allocator_type>::Node;
+    template <typename U>
+    using vector = typename BinarySearchTree<value_type, typename Tree::allocator_type>::template vector<U>;
+
+    void update_node(Node &node) override;
+
+    void swap_nodes(size_t first, size_t second) override;
+
+private:
+    vector<summary_type> summaries;     // by node index, valid for live node indices only
+
+private:
+    [[nodiscard]] summary_type own(const Node &node) const;
+    [[nodiscard]] summary_type summary(size_t index) const;
+};
+
+template <typename Tree, typename Monoid>
+requires Augmentable<Tree> && ::Monoid<Monoid, typename Tree::value_type>
+template <typename... Args>
+requires (!(sizeof...(Args) == 1 && (std::derived_from<std::remove_cvref_t<Args>, AugmentedTree<Tree, Monoid>> && ...)))
+AugmentedTree<Tree, Monoid>::AugmentedTree(Args &&...args)
+        : Tree(std::forward<Args>(args)...), summaries(this->get_allocator()) {
+    this->augmented = true;
+    if(this->empty()) return;
+    vector<size_t> order(this->get_allocator());
+    order.push_back(this->root().get_node_index());
+    for(size_t i = 0; i < order.size(); i++) {
+        const Node &node = this->at(order[i]);
+        if(node.has_left()) order.push_back(node.get_left_index());
+        if(node.has_right()) order.push_back(node.get_right_index());
+    }
+    for(size_t i = order.size(); i-- > 0;) this->update_node(this->at(order[i]));
+}
+
+template <typename Tree, typename Monoid>
+requires Augmentable<Tree> && ::Monoid<Monoid, typename Tree::value_type>
+typename AugmentedTree<Tree, Monoid>::summary_type AugmentedTree<Tree, Monoid>::own(const Node &node) const {
+    return node.is_dead() ? Monoid::identity() : Monoid::lift(node.get_value());
+}
+
+template <typename Tree, typename Monoid>
+requires Augmentable<Tree> && ::Monoid<Monoid, typename Tree::value_type>
+typename AugmentedTree<Tree, Monoid>::summary_type AugmentedTree<Tree, Monoid>::summary(size_t index) const {
+    return index == 0 ? Monoid::identity() : this->summaries[index];
+}
+
+template <typename Tree, typename Monoid>
+requires Augmentable<Tree> && ::Monoid<Monoid, typename Tree::value_type>
+void AugmentedTree<Tree, Monoid>::update_node(Node &node) {
+    Tree::update_node(node);
+    size_t index = node.get_node_index();
+    if(this->summaries.size() <= index) this->summaries.resize(index + 1, Monoid::identity());
+    this->summaries[index] = Monoid::combine(Monoid::combine(this->summary(node.get_left_index()), this->own(node)),
+                                             this->summary(node.get_right_index()));
+}
+
+template <typename Tree, typename Monoid>
+requires Augmentable<Tree> && ::Monoid<Monoid, typename Tree::value_type>
+void AugmentedTree<Tree, Monoid>::swap_nodes(size_t first, size_t second) {
+    Tree::swap_nodes(first, second);
+    std::swap(this->summaries[first], this->summaries[second]);
+}
+
+template <typename Tree, typename Monoid>
+requires Augmentable<Tree> && ::Monoid<Monoid, typename Tree::value_type>
+typename AugmentedTree<Tree, Monoid>::summary_type AugmentedTree<Tree, Monoid>::aggregate() const {
+    if(this->empty()) return Monoid::identity();
+    return this->summary(this->root().get_node_index());
+}
+
+// Descends to the first node inside [low, high], then folds whole right subtrees on the way down to low and whole
+// left subtrees on the way down to high.
+template <typename Tree, typename Monoid>
+requires Augmentable<Tree> && ::Monoid<Monoid, typename Tree::value_type>
+typename AugmentedTree<Tree, Monoid>::summary_type AugmentedTree<Tree, Monoid>::aggregate(const value_type &low, const value_type &high) const {
+    if(this->empty() || high < low) return Monoid::identity();
+    const Node *split = &this->root();
+    while(true) {
+        if(split->get_value() < low) {
+            if(!split->has_right()) return Monoid::identity();
+            split = &split->right();
+        }
+        else if(high < split->get_value()) {
+            if(!split->has_left()) return Monoid::identity();
+            split = &split->left();
+        }
+        else break;
+    }
+
+    summary_type left = Monoid::identity();
+    for(size_t index = split->get_left_index(); index != 0;) {
+        const Node &node = this->at(index);
+        if(node.get_value() < low) index = node.get_right_index();
+        else {
+            left = Monoid::combine(Monoid::combine(this->own(node), this->summary(node.get_right_index())), left);
+            index = node.get_left_index();
+        }
+    }
+    summary_type right = Monoid::identity();
+    for(size_t index = split->get_right_index(); index != 0;) {
+        const Node &node = this->at(index);
+        if(high < node.get_value()) index = node.get_left_index();
+        else {
+            right = Monoid::combine(right, Monoid::combine(this->summary(node.get_left_index()), this->own(node)));
+            index = node.get_right_index();
+        }
+    }
+    return Monoid::combine(Monoid::combine(left, this->own(*split)), right);
+}
+
+template
+class AugmentedTree<AVLTree<int>, SumMonoid<long long>>;
+
+template
+class AugmentedTree<ScapegoatTree<int>, SumMonoid<long long>>;
+
+template
+class AugmentedTree<AVLTree<double>, MaxMonoid<double>>;
+
+template
+class AugmentedTree<ScapegoatTree<double>, MaxMonoid<double>>;
+
+#endif //BINARY_SEARCH_TREES_AUGMENTED_H
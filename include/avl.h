@@ -8,14 +8,15 @@
 
 #include "bst.h"
 #include <iostream>
-#include <unordered_map>
 
-template <typename T>
-class AVLTree : public BinarySearchTree<T> {
+template <typename T, typename Allocator = std::allocator<T>>
+class AVLTree : public BinarySearchTree<T, Allocator> {
 private:
-    using Node = typename BinarySearchTree<T>::Node;
-    using restricted_iterator = typename BinarySearchTree<T>::restricted_iterator;
-    std::unordered_map<int, int> heights;
+    using Node = typename BinarySearchTree<T, Allocator>::Node;
+    using restricted_iterator = typename BinarySearchTree<T, Allocator>::restricted_iterator;
+    template <typename U>
+    using vector = typename BinarySearchTree<T, Allocator>::template vector<U>;
+    vector<int> heights;    // by node index, so a copy of the tree is two vector copies
 private:
     int balance_factor(Node &node);
 
@@ -27,39 +28,58 @@ private:
 
     void update_heights(Node &node);
 
+    Node &insert_node(Node &parent, bool left, const T &value);
+
+protected:
+    // Heights follow nodes through pop(); update_node() runs after every height update, bottom-up.
+    void swap_nodes(size_t first, size_t second) override;
+
 public:
-    using iterator = typename AVLTree<T>::iterator;
+    using iterator = typename AVLTree<T, Allocator>::iterator;
 
-    AVLTree() = default;
+    explicit AVLTree(const Allocator &allocator = Allocator());
 
-    explicit AVLTree(std::vector<T> values);
+    explicit AVLTree(std::vector<T> values, const Allocator &allocator = Allocator());
 
-    iterator insert(const T &value) override;
+    std::pair<iterator, bool> insert(const T &value) override;
+
+    iterator insert(iterator hint, const T &value) override;
 
     void remove(const T &value) override;
 
     bool check_balance();
 };
 
-template<typename T>
-bool AVLTree<T>::check_balance()
+template<typename T, typename Allocator>
+bool AVLTree<T, Allocator>::check_balance()
 {
     return ((balance_factor(this->root()) < 2) && (balance_factor(this->root()) > -2));
 }
 
-template<typename T>
-void AVLTree<T>::update_heights(AVLTree::Node &node)
+template<typename T, typename Allocator>
+void AVLTree<T, Allocator>::update_heights(AVLTree::Node &node)
 {
     heights[node.get_node_index()] = std::max(node.has_left() ? heights[node.get_left_index()] : 0,
                                               node.has_right() ? heights[node.get_right_index()] : 0) + 1;
+    this->update_node(node);
+}
+
+template<typename T, typename Allocator>
+void AVLTree<T, Allocator>::swap_nodes(size_t first, size_t second)
+{
+    std::swap(heights[first], heights[second]);
 }
 
-template<typename T>
-void AVLTree<T>::balance(AVLTree::Node &node)
+// Climbs only while subtree heights change; above the first subtree that keeps its height, after a rotation or
+// not, nothing but augmented data can be stale.
+template<typename T, typename Allocator>
+void AVLTree<T, Allocator>::balance(AVLTree::Node &node)
 {
     Node *node_ptr = &node;
     while (!node_ptr->is_end_node()) {
+        int height = heights[node_ptr->get_node_index()];
         update_heights(*node_ptr);
+        bool rotated = true;
         if (balance_factor(*node_ptr) >= 2 and balance_factor(node_ptr->left()) >= 0)   // left - left
             right_rotate(*node_ptr);
         else if (balance_factor(*node_ptr) >= 2) {  // left - right
@@ -70,13 +90,18 @@ void AVLTree<T>::balance(AVLTree::Node &node)
         else if (balance_factor(*node_ptr) <= -2) {  // right - left
             right_rotate(node_ptr->right());
             left_rotate(*node_ptr);
+        } else rotated = false;
+        if (rotated) node_ptr = &node_ptr->parent();    // the new root of the subtree
+        if (heights[node_ptr->get_node_index()] == height) {
+            this->update_path(node_ptr->parent());
+            return;
         }
         node_ptr = &node_ptr->parent();
     }
 }
 
-template<typename T>
-void AVLTree<T>::left_rotate(AVLTree::Node &node)
+template<typename T, typename Allocator>
+void AVLTree<T, Allocator>::left_rotate(AVLTree::Node &node)
 {
     Node &right_child = node.right();
     node.set_right_index(right_child.get_left_index());
@@ -91,8 +116,8 @@ void AVLTree<T>::left_rotate(AVLTree::Node &node)
     update_heights(right_child);
 }
 
-template<typename T>
-void AVLTree<T>::right_rotate(AVLTree::Node &node)
+template<typename T, typename Allocator>
+void AVLTree<T, Allocator>::right_rotate(AVLTree::Node &node)
 {
     Node &left_child = node.left();
     node.set_left_index(left_child.get_right_index());
@@ -107,90 +132,62 @@ void AVLTree<T>::right_rotate(AVLTree::Node &node)
     update_heights(left_child);
 }
 
-template<typename T>
-int AVLTree<T>::balance_factor(AVLTree::Node &node)
+template<typename T, typename Allocator>
+int AVLTree<T, Allocator>::balance_factor(AVLTree::Node &node)
 {
     return (node.has_left() ? heights[node.left().get_node_index()] : 0) -
            (node.has_right() ? heights[node.right().get_node_index()] : 0);
 }
 
-template<typename T>
-void AVLTree<T>::remove(const T &value)
+template<typename T, typename Allocator>
+void AVLTree<T, Allocator>::remove(const T &value)
 {
     restricted_iterator it = this->lookup(value);
     if (it == this->end()) return;
-    Node &node = it.get_node();
-    if (!node.has_left() && !node.has_right()) {
-
-        std::swap(heights[node.get_node_index()], heights[this->back().get_node_index()]);
-        this->remove_node_no_children(node);
-        Node &parent = node.parent();
-        balance(parent);
-    } else if (!node.has_left() || !node.has_right()) {
-
-        std::swap(heights[node.get_node_index()], heights[this->back().get_node_index()]);
-        this->remove_node_one_child(node);
-        Node &parent = node.parent();
-        balance(parent);
-    } else {
-        Node *current_node = &node;
-        while (true) {
-            it++;
-            Node &next = it.get_node();
-            current_node->set_value(next.get_value());
-            if (!next.has_right() && !next.has_left()) {
-                std::swap(heights[next.get_node_index()], heights[this->back().get_node_index()]);
-                this->remove_node_no_children(next);
-                Node &parent = next.parent();
-                balance(parent);
-                break;
-            } else if (!next.has_right() || !next.has_left()) {
-
-                std::swap(heights[next.get_node_index()], heights[this->back().get_node_index()]);
-                this->remove_node_one_child(next);
-                Node &parent = next.parent();
-                balance(parent);
-                break;
-            } else current_node = &next;
-        }
+    this->filter_remove(value);
+    Node *node = &it.get_node();
+    if (node->has_left() && node->has_right()) {
+        it++;
+        Node &next = it.get_node();
+        node->set_value(next.get_value());
+        node = &next;
     }
+    balance(this->at(this->detach(*node)));
 }
 
-template<typename T>
-AVLTree<T>::iterator AVLTree<T>::insert(const T &value)
+template<typename T, typename Allocator>
+std::pair<typename AVLTree<T, Allocator>::iterator, bool> AVLTree<T, Allocator>::insert(const T &value)
 {
-    if (this->empty()) {
-        this->emplace(value);
-        return this->begin();
-    }
+    auto [parent, left, exists] = this->find_insert_position(value);
+    if(exists) return {iterator(*parent), false};
+    return {iterator(insert_node(*parent, left, value)), true};
+}
 
-    Node *node = &this->root();
-
-    while (true) {
-        if (value < node->get_value()) {
-            if (!node->has_left()) {
-                node->set_left_index(this->next_index());
-                this->emplace(value, node->get_node_index());
-                break;
-            }
-            node = &node->left();
-        } else if (value > node->get_value()) {
-            if (!node->has_right()) {
-                node->set_right_index(this->next_index());
-                this->emplace(value, node->get_node_index());
-                break;
-            }
-            node = &node->right();
-        } else throw DuplicateElement();
-    }
-    Node &new_node = this->back();
+template<typename T, typename Allocator>
+AVLTree<T, Allocator>::iterator AVLTree<T, Allocator>::insert(iterator hint, const T &value)
+{
+    auto [parent, left, exists] = this->find_insert_position(hint, value);
+    if(exists) return iterator(*parent);
+    return iterator(insert_node(*parent, left, value));
+}
+
+template<typename T, typename Allocator>
+typename AVLTree<T, Allocator>::Node &AVLTree<T, Allocator>::insert_node(Node &parent, bool left, const T &value)
+{
+    Node &new_node = this->attach(parent, left, value);
+    if (heights.size() <= new_node.get_node_index()) heights.resize(new_node.get_node_index() + 1);
     heights[new_node.get_node_index()] = 1;
-    balance(new_node);
-    return this->find(value);
+    this->update_node(new_node);
+    balance(new_node.parent());
+    return new_node;
 }
 
-template<typename T>
-AVLTree<T>::AVLTree(std::vector<T> values)
+template<typename T, typename Allocator>
+AVLTree<T, Allocator>::AVLTree(const Allocator &allocator) : BinarySearchTree<T, Allocator>(allocator), heights(allocator)
+{}
+
+template<typename T, typename Allocator>
+AVLTree<T, Allocator>::AVLTree(std::vector<T> values, const Allocator &allocator) : AVLTree(allocator)
 {
     for(auto value : values) {
         this->insert(value);
@@ -224,5 +221,9 @@ class AVLTree<char>;
 template
 class AVLTree<unsigned char>;
 
+namespace pmr {
+    template <typename T>
+    using AVLTree = ::AVLTree<T, std::pmr::polymorphic_allocator<T>>;
+}
 
 #endif //BINARY_SEARCH_TREES_AVL_H
@@ -0,0 +1,136 @@
+#ifndef BINARY_SEARCH_TREES_BALANCED_H
+#define BINARY_SEARCH_TREES_BALANCED_H
+
+#include "avl.h"
+#include "scapegoat.h"
+#include "redblack.h"
+#include "splay.h"
+
+// Balancing strategies for BalancedTree, each naming the tree that implements it.
+struct AVLPolicy {
+    template <typename T, typename Allocator>
+    using engine = AVLTree<T, Allocator>;
+};
+
+struct ScapegoatPolicy {
+    template <typename T, typename Allocator>
+    using engine = ScapegoatTree<T, Allocator>;
+};
+
+struct RedBlackPolicy {
+    template <typename T, typename Allocator>
+    using engine = RedBlackTree<T, Allocator>;
+};
+
+struct SplayPolicy {
+    template <typename T, typename Allocator>
+    using engine = SplayTree<T, Allocator>;
+};
+
+// The balancing strategy as a compile-time parameter: BalancedTree<int, AVLPolicy> is an AVLTree<int> that is final
+// and calls its engine by qualified name, so insert(), remove(), find(), contains() and the min/max pops bind
+// statically and inline into the caller's loop instead of going through the vtable. It still is a
+// BinarySearchTree, and callers that pick the strategy at run time keep using a BinarySearchTree<T> &.
+template <typename T, typename Policy, typename Allocator = std::allocator<T>>
+class BalancedTree final : public Policy::template engine<T, Allocator> {
+private:
+    using Engine = typename Policy::template engine<T, Allocator>;
+public:
+    using iterator = typename Engine::iterator;
+    using policy_type = Policy;
+
+    using Engine::Engine;
+    std::pair<iterator, bool> insert(const T &value) override;
+    iterator insert(iterator hint, const T &value) override;
+    void remove(const T &value) override;
+    iterator find(const T &value) override;
+    [[nodiscard]] bool contains(const T &value);
+    T pop_min();
+    T pop_max();
+};
+
+template <typename T, typename Policy, typename Allocator>
+std::pair<typename BalancedTree<T, Policy, Allocator>::iterator, bool>
+BalancedTree<T, Policy, Allocator>::insert(const T &value) {
+    return Engine::insert(value);
+}
+
+template <typename T, typename Policy, typename Allocator>
+typename BalancedTree<T, Policy, Allocator>::iterator
+BalancedTree<T, Policy, Allocator>::insert(iterator hint, const T &value) {
+    return Engine::insert(hint, value);
+}
+
+template <typename T, typename Policy, typename Allocator>
+void BalancedTree<T, Policy, Allocator>::remove(const T &value) {
+    Engine::remove(value);
+}
+
+template <typename T, typename Policy, typename Allocator>
+typename BalancedTree<T, Policy, Allocator>::iterator BalancedTree<T, Policy, Allocator>::find(const T &value) {
+    return Engine::find(value);
+}
+
+template <typename T, typename Policy, typename Allocator>
+bool BalancedTree<T, Policy, Allocator>::contains(const T &value) {
+    return Engine::find(value) != this->end();
+}
+
+template <typename T, typename Policy, typename Allocator>
+T BalancedTree<T, Policy, Allocator>::pop_min() {
+    if(this->size() == 0) throw TreeEmptyException("pop_min");
+    T value = this->min();
+    Engine::remove(value);
+    return value;
+}
+
+template <typename T, typename Policy, typename Allocator>
+T BalancedTree<T, Policy, Allocator>::pop_max() {
+    if(this->size() == 0) throw TreeEmptyException("pop_max");
+    T value = this->max();
+    Engine::remove(value);
+    return value;
+}
+
+template
+class BalancedTree<int, AVLPolicy>;
+
+template
+class BalancedTree<double, AVLPolicy>;
+
+template
+class BalancedTree<long long, AVLPolicy>;
+
+template
+class BalancedTree<int, ScapegoatPolicy>;
+
+template
+class BalancedTree<double, ScapegoatPolicy>;
+
+template
+class BalancedTree<long long, ScapegoatPolicy>;
+
+template
+class BalancedTree<int, RedBlackPolicy>;
+
+template
+class BalancedTree<double, RedBlackPolicy>;
+
+template
+class BalancedTree<long long, RedBlackPolicy>;
+
+template
+class BalancedTree<int, SplayPolicy>;
+
+template
+class BalancedTree<double, SplayPolicy>;
+
+template
+class BalancedTree<long long, SplayPolicy>;
+
+namespace pmr {
+    template <typename T, typename Policy>
+    using BalancedTree = ::BalancedTree<T, Policy, std::pmr::polymorphic_allocator<T>>;
+}
+
+#endif //BINARY_SEARCH_TREES_BALANCED_H
@@ -0,0 +1,147 @@
+#ifndef BINARY_SEARCH_TREES_BLOOM_H
+#define BINARY_SEARCH_TREES_BLOOM_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <concepts>
+
+template <typename T>
+concept Hashable = requires(const T &value) {
+    { std::hash<T>()(value) } -> std::convertible_to<size_t>;
+};
+
+// Counting Bloom filter with 4-bit saturating counters. All counters of a key sit in one 64 byte block, so a
+// membership test costs a single cache miss. A counter that reached 15 is never decremented again, which keeps
+// remove() from ever producing a false negative.
+template <typename T, typename Allocator = std::allocator<T>>
+class CountingBloomFilter {
+public:
+    explicit CountingBloomFilter(const Allocator &allocator = Allocator());
+    // Clears the filter and sizes it for `capacity` keys at the given false positive rate.
+    void reset(size_t capacity, double false_positive_rate);
+    void insert(const T &value);
+    void remove(const T &value);
+    [[nodiscard]] bool might_contain(const T &value) const;
+    [[nodiscard]] size_t get_capacity() const;
+    [[nodiscard]] double get_false_positive_rate() const;
+    [[nodiscard]] size_t memory_usage() const;
+
+private:
+    static constexpr size_t block_bytes = 64;
+    static constexpr size_t block_counters = 2 * block_bytes;
+    static constexpr unsigned counter_max = 15;
+    std::vector<uint8_t, typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t>> counters;
+    size_t block_count = 0;
+    unsigned hash_count = 0;
+    size_t capacity = 0;
+    double false_positive_rate = 0;
+
+private:
+    static uint64_t mix(uint64_t hash);
+    [[nodiscard]] static double blocked_false_positive_rate(double keys_per_block, unsigned hash_count);
+    template <typename Function>
+    void for_each_counter(const T &value, Function fn) const;
+};
+
+template <typename T, typename Allocator>
+CountingBloomFilter<T, Allocator>::CountingBloomFilter(const Allocator &allocator) : counters(allocator) {}
+
+template <typename T, typename Allocator>
+void CountingBloomFilter<T, Allocator>::reset(size_t capacity, double false_positive_rate) {
+    this->capacity = std::max<size_t>(capacity, 1);
+    this->false_positive_rate = std::clamp(false_positive_rate, 1e-9, .5);
+    double counters_per_key = -std::log(this->false_positive_rate) / (std::log(2) * std::log(2));
+    this->hash_count = std::clamp(static_cast<unsigned>(std::lround(counters_per_key * std::log(2))), 1u, 16u);
+    // Block loads vary, so the classic sizing undershoots; grow until the blocked estimate meets the target.
+    while(blocked_false_positive_rate(block_counters / counters_per_key, this->hash_count) > this->false_positive_rate) {
+        counters_per_key *= 1.05;
+    }
+    this->block_count = static_cast<size_t>(std::ceil(this->capacity * counters_per_key / block_counters));
+    this->block_count = std::max<size_t>(this->block_count, 1);
+    this->counters.assign(this->block_count * block_bytes, 0);
+}
+
+// splitmix64 finaliser, so identity hashes of integers still spread over the blocks.
+template <typename T, typename Allocator>
+uint64_t CountingBloomFilter<T, Allocator>::mix(uint64_t hash) {
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
+    return hash ^ (hash >> 31);
+}
+
+// Poisson mixture over the number of keys sharing a block, each term being the classic rate inside one block.
+template <typename T, typename Allocator>
+double CountingBloomFilter<T, Allocator>::blocked_false_positive_rate(double keys_per_block, unsigned hash_count) {
+    double result = 0, probability = std::exp(-keys_per_block);
+    for(size_t keys = 0; keys < 4 * keys_per_block + 32; keys++) {
+        double empty = std::pow(1 - 1. / block_counters, static_cast<double>(keys * hash_count));
+        result += probability * std::pow(1 - empty, hash_count);
+        probability *= keys_per_block / static_cast<double>(keys + 1);
+    }
+    return result;
+}
+
+// One hash picks the block, a second one supplies seven bits per counter inside it.
+template <typename T, typename Allocator>
+template <typename Function>
+void CountingBloomFilter<T, Allocator>::for_each_counter(const T &value, Function fn) const {
+    uint64_t hash = mix(std::hash<T>()(value));
+    size_t block = hash % this->block_count * block_bytes;
+    uint64_t bits = mix(hash);
+    for(unsigned i = 0, available = 9; i < this->hash_count; i++, available--) {
+        if(available == 0) {
+            bits = mix(bits);
+            available = 9;
+        }
+        size_t counter = bits & (block_counters - 1);
+        bits >>= 7;
+        fn(block + counter / 2, (counter % 2) * 4);
+    }
+}
+
+template <typename T, typename Allocator>
+void CountingBloomFilter<T, Allocator>::insert(const T &value) {
+    this->for_each_counter(value, [this](size_t byte, unsigned shift) {
+        uint8_t &cell = this->counters[byte];
+        if(((cell >> shift) & 0xF) < counter_max) cell += static_cast<uint8_t>(1 << shift);
+    });
+}
+
+template <typename T, typename Allocator>
+void CountingBloomFilter<T, Allocator>::remove(const T &value) {
+    this->for_each_counter(value, [this](size_t byte, unsigned shift) {
+        uint8_t &cell = this->counters[byte];
+        unsigned count = (cell >> shift) & 0xF;
+        if(count > 0 && count < counter_max) cell -= static_cast<uint8_t>(1 << shift);
+    });
+}
+
+template <typename T, typename Allocator>
+bool CountingBloomFilter<T, Allocator>::might_contain(const T &value) const {
+    bool present = true;
+    this->for_each_counter(value, [this, &present](size_t byte, unsigned shift) {
+        if(((this->counters[byte] >> shift) & 0xF) == 0) present = false;
+    });
+    return present;
+}
+
+template <typename T, typename Allocator>
+size_t CountingBloomFilter<T, Allocator>::get_capacity() const {
+    return this->capacity;
+}
+
+template <typename T, typename Allocator>
+double CountingBloomFilter<T, Allocator>::get_false_positive_rate() const {
+    return this->false_positive_rate;
+}
+
+template <typename T, typename Allocator>
+size_t CountingBloomFilter<T, Allocator>::memory_usage() const {
+    return this->counters.capacity();
+}
+
+#endif //BINARY_SEARCH_TREES_BLOOM_H
@@ -0,0 +1,558 @@
+#ifndef BINARY_SEARCH_TREES_BPLUS_H
+#define BINARY_SEARCH_TREES_BPLUS_H
+
+#include "bst.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+// Sized so the key array of a node spans two 64 byte cache lines.
+template <typename T>
+constexpr size_t bplus_default_fanout() {
+    return std::max<size_t>(8, 128 / sizeof(T));
+}
+
+template <typename T, size_t Fanout = bplus_default_fanout<T>(), typename Allocator = std::allocator<T>>
+class BPlusTree {
+    static_assert(Fanout >= 4, "BPlusTree needs room for at least four keys per node");
+public:
+    class Iterator;
+    using iterator = Iterator;
+    using allocator_type = Allocator;
+    explicit BPlusTree(const Allocator &allocator = Allocator());
+    explicit BPlusTree(std::vector<T> values, const Allocator &allocator = Allocator());
+    std::pair<iterator, bool> insert(const T &value);
+    void remove(const T &value);
+    iterator find(const T &value);
+    iterator predecessor_find(const T &value);
+    iterator successor_find(const T &value);
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] allocator_type get_allocator() const;
+    iterator begin();
+    iterator end();
+public:
+    class Iterator {
+    public:
+        using DataType = T;
+        using PointerType = DataType*;
+        using RefType = DataType&;
+
+        Iterator &operator++();
+        Iterator operator++(int);
+
+        Iterator &operator--();
+        Iterator operator--(int);
+        Iterator operator+(int n) const;
+        Iterator operator-(int n) const;
+        Iterator &operator+=(int n);
+        Iterator &operator-=(int n);
+        RefType operator*() const;
+        bool operator==(const Iterator &other) const;
+        bool operator!=(const Iterator &other) const;
+        bool operator<(const Iterator &other) const;
+        bool operator<=(const Iterator &other) const;
+        bool operator>(const Iterator &other) const;
+        bool operator>=(const Iterator &other) const;
+
+        Iterator(BPlusTree *p_tree, size_t leaf_index, size_t slot);
+    private:
+        BPlusTree *p_tree;
+        size_t leaf_index;
+        size_t slot;
+    private:
+        [[nodiscard]] bool is_end() const;
+    };
+private:
+    static constexpr size_t no_node = SIZE_MAX;
+    static constexpr size_t min_keys = Fanout / 2;
+    static constexpr size_t max_height = 64;
+    struct Leaf {
+        size_t count = 0;
+        size_t prev = no_node;
+        size_t next = no_node;
+        std::array<T, Fanout> keys;
+    };
+    struct Inner {
+        size_t count = 0;
+        std::array<T, Fanout> keys;
+        std::array<size_t, Fanout + 1> children;
+    };
+    struct PathEntry {
+        size_t node_index;
+        size_t slot;
+    };
+    template <typename U>
+    using vector = std::vector<U, typename std::allocator_traits<Allocator>::template rebind_alloc<U>>;
+private:
+    vector<Leaf> leaves;
+    vector<Inner> inners;
+    vector<size_t> free_leaves;
+    vector<size_t> free_inners;
+    size_t root_index = 0;
+    size_t height = 0;
+    size_t first_leaf = 0;
+    size_t last_leaf = 0;
+    size_t element_count = 0;
+private:
+    size_t descend(const T &value, std::array<PathEntry, max_height> &path);
+    size_t descend(const T &value);
+    size_t allocate_leaf();
+    size_t allocate_inner();
+    void insert_into_parents(std::array<PathEntry, max_height> &path, T separator, size_t child);
+    void fix_leaf_underflow(std::array<PathEntry, max_height> &path, size_t leaf_index);
+    void fix_inner_underflow(std::array<PathEntry, max_height> &path, size_t level);
+};
+
+template <typename T, size_t Fanout, typename Allocator>
+BPlusTree<T, Fanout, Allocator>::BPlusTree(const Allocator &allocator)
+        : leaves(allocator), inners(allocator), free_leaves(allocator), free_inners(allocator) {
+    this->leaves.emplace_back();
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+BPlusTree<T, Fanout, Allocator>::BPlusTree(std::vector<T> values, const Allocator &allocator) : BPlusTree(allocator) {
+    for(auto value : values) {
+        this->insert(value);
+    }
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+size_t BPlusTree<T, Fanout, Allocator>::size() const {
+    return this->element_count;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::allocator_type BPlusTree<T, Fanout, Allocator>::get_allocator() const {
+    return Allocator(this->leaves.get_allocator());
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+size_t BPlusTree<T, Fanout, Allocator>::allocate_leaf() {
+    if(this->free_leaves.empty()) {
+        this->leaves.emplace_back();
+        return this->leaves.size() - 1;
+    }
+    size_t index = this->free_leaves.back();
+    this->free_leaves.pop_back();
+    this->leaves[index] = Leaf();
+    return index;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+size_t BPlusTree<T, Fanout, Allocator>::allocate_inner() {
+    if(this->free_inners.empty()) {
+        this->inners.emplace_back();
+        return this->inners.size() - 1;
+    }
+    size_t index = this->free_inners.back();
+    this->free_inners.pop_back();
+    this->inners[index] = Inner();
+    return index;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+size_t BPlusTree<T, Fanout, Allocator>::descend(const T &value, std::array<PathEntry, max_height> &path) {
+    size_t node_index = this->root_index;
+    for(size_t level = 0; level < this->height; level++) {
+        const Inner &inner = this->inners[node_index];
+        size_t slot = std::upper_bound(inner.keys.begin(), inner.keys.begin() + inner.count, value) - inner.keys.begin();
+        path[level] = {node_index, slot};
+        node_index = inner.children[slot];
+    }
+    return node_index;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+size_t BPlusTree<T, Fanout, Allocator>::descend(const T &value) {
+    size_t node_index = this->root_index;
+    for(size_t level = 0; level < this->height; level++) {
+        const Inner &inner = this->inners[node_index];
+        node_index = inner.children[std::upper_bound(inner.keys.begin(), inner.keys.begin() + inner.count, value) -
+                                    inner.keys.begin()];
+    }
+    return node_index;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+std::pair<typename BPlusTree<T, Fanout, Allocator>::iterator, bool> BPlusTree<T, Fanout, Allocator>::insert(const T &value) {
+    std::array<PathEntry, max_height> path;
+    size_t leaf_index = this->descend(value, path);
+    Leaf *leaf = &this->leaves[leaf_index];
+    size_t position = std::lower_bound(leaf->keys.begin(), leaf->keys.begin() + leaf->count, value) - leaf->keys.begin();
+    if(position < leaf->count && leaf->keys[position] == value) return {iterator(this, leaf_index, position), false};
+    this->element_count++;
+
+    if(leaf->count < Fanout) {
+        std::move_backward(leaf->keys.begin() + position, leaf->keys.begin() + leaf->count,
+                           leaf->keys.begin() + leaf->count + 1);
+        leaf->keys[position] = value;
+        leaf->count++;
+        return {iterator(this, leaf_index, position), true};
+    }
+
+    std::array<T, Fanout + 1> keys;
+    std::copy(leaf->keys.begin(), leaf->keys.begin() + position, keys.begin());
+    keys[position] = value;
+    std::copy(leaf->keys.begin() + position, leaf->keys.end(), keys.begin() + position + 1);
+
+    size_t right_index = this->allocate_leaf();
+    leaf = &this->leaves[leaf_index];
+    Leaf &right = this->leaves[right_index];
+    size_t left_count = (Fanout + 1) / 2;
+    std::copy(keys.begin(), keys.begin() + left_count, leaf->keys.begin());
+    std::copy(keys.begin() + left_count, keys.end(), right.keys.begin());
+    leaf->count = left_count;
+    right.count = Fanout + 1 - left_count;
+    right.prev = leaf_index;
+    right.next = leaf->next;
+    if(leaf->next != no_node) this->leaves[leaf->next].prev = right_index;
+    else this->last_leaf = right_index;
+    leaf->next = right_index;
+
+    this->insert_into_parents(path, right.keys[0], right_index);
+    if(position < left_count) return {iterator(this, leaf_index, position), true};
+    return {iterator(this, right_index, position - left_count), true};
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+void BPlusTree<T, Fanout, Allocator>::insert_into_parents(std::array<PathEntry, max_height> &path, T separator, size_t child) {
+    for(size_t level = this->height; level-- > 0;) {
+        size_t inner_index = path[level].node_index;
+        size_t slot = path[level].slot;
+        Inner *inner = &this->inners[inner_index];
+        if(inner->count < Fanout) {
+            std::move_backward(inner->keys.begin() + slot, inner->keys.begin() + inner->count,
+                               inner->keys.begin() + inner->count + 1);
+            std::move_backward(inner->children.begin() + slot + 1, inner->children.begin() + inner->count + 1,
+                               inner->children.begin() + inner->count + 2);
+            inner->keys[slot] = separator;
+            inner->children[slot + 1] = child;
+            inner->count++;
+            return;
+        }
+
+        std::array<T, Fanout + 1> keys;
+        std::array<size_t, Fanout + 2> children;
+        std::copy(inner->keys.begin(), inner->keys.begin() + slot, keys.begin());
+        keys[slot] = separator;
+        std::copy(inner->keys.begin() + slot, inner->keys.end(), keys.begin() + slot + 1);
+        std::copy(inner->children.begin(), inner->children.begin() + slot + 1, children.begin());
+        children[slot + 1] = child;
+        std::copy(inner->children.begin() + slot + 1, inner->children.end(), children.begin() + slot + 2);
+
+        size_t right_index = this->allocate_inner();
+        inner = &this->inners[inner_index];
+        Inner &right = this->inners[right_index];
+        size_t left_count = (Fanout + 1) / 2;
+        std::copy(keys.begin(), keys.begin() + left_count, inner->keys.begin());
+        std::copy(children.begin(), children.begin() + left_count + 1, inner->children.begin());
+        std::copy(keys.begin() + left_count + 1, keys.end(), right.keys.begin());
+        std::copy(children.begin() + left_count + 1, children.end(), right.children.begin());
+        inner->count = left_count;
+        right.count = Fanout - left_count;
+
+        separator = keys[left_count];
+        child = right_index;
+    }
+
+    size_t new_root = this->allocate_inner();
+    Inner &root = this->inners[new_root];
+    root.count = 1;
+    root.keys[0] = separator;
+    root.children[0] = this->root_index;
+    root.children[1] = child;
+    this->root_index = new_root;
+    this->height++;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+void BPlusTree<T, Fanout, Allocator>::remove(const T &value) {
+    std::array<PathEntry, max_height> path;
+    size_t leaf_index = this->descend(value, path);
+    Leaf &leaf = this->leaves[leaf_index];
+    size_t position = std::lower_bound(leaf.keys.begin(), leaf.keys.begin() + leaf.count, value) - leaf.keys.begin();
+    if(position == leaf.count || leaf.keys[position] != value) return;
+
+    std::move(leaf.keys.begin() + position + 1, leaf.keys.begin() + leaf.count, leaf.keys.begin() + position);
+    leaf.count--;
+    this->element_count--;
+    if(this->height > 0 && leaf.count < min_keys) this->fix_leaf_underflow(path, leaf_index);
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+void BPlusTree<T, Fanout, Allocator>::fix_leaf_underflow(std::array<PathEntry, max_height> &path, size_t leaf_index) {
+    Inner &parent = this->inners[path[this->height - 1].node_index];
+    size_t slot = path[this->height - 1].slot;
+    Leaf &leaf = this->leaves[leaf_index];
+
+    if(slot > 0 && this->leaves[parent.children[slot - 1]].count > min_keys) {
+        Leaf &left = this->leaves[parent.children[slot - 1]];
+        std::move_backward(leaf.keys.begin(), leaf.keys.begin() + leaf.count, leaf.keys.begin() + leaf.count + 1);
+        leaf.keys[0] = left.keys[left.count - 1];
+        leaf.count++;
+        left.count--;
+        parent.keys[slot - 1] = leaf.keys[0];
+        return;
+    }
+    if(slot < parent.count && this->leaves[parent.children[slot + 1]].count > min_keys) {
+        Leaf &right = this->leaves[parent.children[slot + 1]];
+        leaf.keys[leaf.count] = right.keys[0];
+        leaf.count++;
+        std::move(right.keys.begin() + 1, right.keys.begin() + right.count, right.keys.begin());
+        right.count--;
+        parent.keys[slot] = right.keys[0];
+        return;
+    }
+
+    size_t key_slot = slot > 0 ? slot - 1 : slot;
+    size_t left_index = parent.children[key_slot];
+    size_t right_index = parent.children[key_slot + 1];
+    Leaf &left = this->leaves[left_index];
+    Leaf &right = this->leaves[right_index];
+    std::copy(right.keys.begin(), right.keys.begin() + right.count, left.keys.begin() + left.count);
+    left.count += right.count;
+    left.next = right.next;
+    if(right.next != no_node) this->leaves[right.next].prev = left_index;
+    else this->last_leaf = left_index;
+    this->free_leaves.push_back(right_index);
+
+    std::move(parent.keys.begin() + key_slot + 1, parent.keys.begin() + parent.count, parent.keys.begin() + key_slot);
+    std::move(parent.children.begin() + key_slot + 2, parent.children.begin() + parent.count + 1,
+              parent.children.begin() + key_slot + 1);
+    parent.count--;
+    this->fix_inner_underflow(path, this->height - 1);
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+void BPlusTree<T, Fanout, Allocator>::fix_inner_underflow(std::array<PathEntry, max_height> &path, size_t level) {
+    while(true) {
+        size_t node_index = path[level].node_index;
+        Inner &node = this->inners[node_index];
+        if(level == 0) {
+            if(node.count == 0) {
+                this->root_index = node.children[0];
+                this->free_inners.push_back(node_index);
+                this->height--;
+            }
+            return;
+        }
+        if(node.count >= min_keys) return;
+
+        Inner &parent = this->inners[path[level - 1].node_index];
+        size_t slot = path[level - 1].slot;
+
+        if(slot > 0 && this->inners[parent.children[slot - 1]].count > min_keys) {
+            Inner &left = this->inners[parent.children[slot - 1]];
+            std::move_backward(node.keys.begin(), node.keys.begin() + node.count, node.keys.begin() + node.count + 1);
+            std::move_backward(node.children.begin(), node.children.begin() + node.count + 1,
+                               node.children.begin() + node.count + 2);
+            node.keys[0] = parent.keys[slot - 1];
+            node.children[0] = left.children[left.count];
+            node.count++;
+            parent.keys[slot - 1] = left.keys[left.count - 1];
+            left.count--;
+            return;
+        }
+        if(slot < parent.count && this->inners[parent.children[slot + 1]].count > min_keys) {
+            Inner &right = this->inners[parent.children[slot + 1]];
+            node.keys[node.count] = parent.keys[slot];
+            node.children[node.count + 1] = right.children[0];
+            node.count++;
+            parent.keys[slot] = right.keys[0];
+            std::move(right.keys.begin() + 1, right.keys.begin() + right.count, right.keys.begin());
+            std::move(right.children.begin() + 1, right.children.begin() + right.count + 1, right.children.begin());
+            right.count--;
+            return;
+        }
+
+        size_t key_slot = slot > 0 ? slot - 1 : slot;
+        size_t right_index = parent.children[key_slot + 1];
+        Inner &left = this->inners[parent.children[key_slot]];
+        Inner &right = this->inners[right_index];
+        left.keys[left.count] = parent.keys[key_slot];
+        std::copy(right.keys.begin(), right.keys.begin() + right.count, left.keys.begin() + left.count + 1);
+        std::copy(right.children.begin(), right.children.begin() + right.count + 1,
+                  left.children.begin() + left.count + 1);
+        left.count += right.count + 1;
+        this->free_inners.push_back(right_index);
+
+        std::move(parent.keys.begin() + key_slot + 1, parent.keys.begin() + parent.count, parent.keys.begin() + key_slot);
+        std::move(parent.children.begin() + key_slot + 2, parent.children.begin() + parent.count + 1,
+                  parent.children.begin() + key_slot + 1);
+        parent.count--;
+        level--;
+    }
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::iterator BPlusTree<T, Fanout, Allocator>::find(const T &value) {
+    size_t leaf_index = this->descend(value);
+    const Leaf &leaf = this->leaves[leaf_index];
+    size_t position = std::lower_bound(leaf.keys.begin(), leaf.keys.begin() + leaf.count, value) - leaf.keys.begin();
+    if(position == leaf.count || leaf.keys[position] != value) return this->end();
+    return iterator(this, leaf_index, position);
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::iterator BPlusTree<T, Fanout, Allocator>::successor_find(const T &value) {
+    size_t leaf_index = this->descend(value);
+    const Leaf &leaf = this->leaves[leaf_index];
+    size_t position = std::lower_bound(leaf.keys.begin(), leaf.keys.begin() + leaf.count, value) - leaf.keys.begin();
+    if(position < leaf.count) return iterator(this, leaf_index, position);
+    if(leaf.next == no_node) return this->end();
+    return iterator(this, leaf.next, 0);
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::iterator BPlusTree<T, Fanout, Allocator>::predecessor_find(const T &value) {
+    size_t leaf_index = this->descend(value);
+    const Leaf &leaf = this->leaves[leaf_index];
+    size_t position = std::upper_bound(leaf.keys.begin(), leaf.keys.begin() + leaf.count, value) - leaf.keys.begin();
+    if(position > 0) return iterator(this, leaf_index, position - 1);
+    if(leaf.prev == no_node) return this->end();
+    return iterator(this, leaf.prev, this->leaves[leaf.prev].count - 1);
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::iterator BPlusTree<T, Fanout, Allocator>::begin() {
+    if(this->element_count == 0) return this->end();
+    return iterator(this, this->first_leaf, 0);
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::iterator BPlusTree<T, Fanout, Allocator>::end() {
+    return iterator(this, no_node, 0);
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+BPlusTree<T, Fanout, Allocator>::Iterator::Iterator(BPlusTree *p_tree, size_t leaf_index, size_t slot)
+        : p_tree(p_tree), leaf_index(leaf_index), slot(slot) {}
+
+template <typename T, size_t Fanout, typename Allocator>
+bool BPlusTree<T, Fanout, Allocator>::Iterator::is_end() const {
+    return this->leaf_index == no_node;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::iterator &BPlusTree<T, Fanout, Allocator>::iterator::operator++() {
+    if(this->is_end()) return *this;
+    const Leaf &leaf = this->p_tree->leaves[this->leaf_index];
+    if(++this->slot < leaf.count) return *this;
+    this->leaf_index = leaf.next;
+    this->slot = 0;
+    return *this;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::iterator BPlusTree<T, Fanout, Allocator>::iterator::operator++(int) {
+    iterator temp = *this;
+    ++*this;
+    return temp;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::iterator &BPlusTree<T, Fanout, Allocator>::iterator::operator--() {
+    if(this->is_end()) {
+        if(this->p_tree->element_count == 0) return *this;
+        this->leaf_index = this->p_tree->last_leaf;
+        this->slot = this->p_tree->leaves[this->leaf_index].count - 1;
+        return *this;
+    }
+    if(this->slot > 0) {
+        this->slot--;
+        return *this;
+    }
+    this->leaf_index = this->p_tree->leaves[this->leaf_index].prev;
+    if(!this->is_end()) this->slot = this->p_tree->leaves[this->leaf_index].count - 1;
+    return *this;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::iterator BPlusTree<T, Fanout, Allocator>::iterator::operator--(int) {
+    iterator temp = *this;
+    --*this;
+    return temp;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::iterator BPlusTree<T, Fanout, Allocator>::iterator::operator+(int n) const {
+    iterator temp = *this;
+    int sign = n > 0 ? 1 : -1;
+    n = n > 0 ? n : -n;
+    while(n--) {
+        if(sign > 0) ++temp;
+        else --temp;
+    }
+    return temp;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::iterator BPlusTree<T, Fanout, Allocator>::iterator::operator-(int n) const {
+    return *this + -n;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::iterator &BPlusTree<T, Fanout, Allocator>::iterator::operator+=(int n) {
+    *this = *this + n;
+    return *this;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::iterator &BPlusTree<T, Fanout, Allocator>::iterator::operator-=(int n) {
+    return *this += -n;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+typename BPlusTree<T, Fanout, Allocator>::iterator::RefType BPlusTree<T, Fanout, Allocator>::iterator::operator*() const {
+    return this->p_tree->leaves[this->leaf_index].keys[this->slot];
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+bool BPlusTree<T, Fanout, Allocator>::iterator::operator==(const iterator &other) const {
+    if(this->is_end() || other.is_end()) return this->is_end() == other.is_end();
+    return this->leaf_index == other.leaf_index && this->slot == other.slot;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+bool BPlusTree<T, Fanout, Allocator>::iterator::operator!=(const iterator &other) const {
+    return !(*this == other);
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+bool BPlusTree<T, Fanout, Allocator>::iterator::operator<(const iterator &other) const {
+    if(this->is_end()) return false;
+    if(other.is_end()) return true;
+    return **this < *other;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+bool BPlusTree<T, Fanout, Allocator>::iterator::operator<=(const iterator &other) const {
+    return !(other < *this);
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+bool BPlusTree<T, Fanout, Allocator>::iterator::operator>(const iterator &other) const {
+    return other < *this;
+}
+
+template <typename T, size_t Fanout, typename Allocator>
+bool BPlusTree<T, Fanout, Allocator>::iterator::operator>=(const iterator &other) const {
+    return !(*this < other);
+}
+
+template class BPlusTree<int>;
+template class BPlusTree<float>;
+template class BPlusTree<double>;
+template class BPlusTree<unsigned int>;
+template class BPlusTree<unsigned long long>;
+template class BPlusTree<long long>;
+template class BPlusTree<short>;
+template class BPlusTree<char>;
+template class BPlusTree<unsigned char>;
+
+namespace pmr {
+    template <typename T, size_t Fanout = bplus_default_fanout<T>()>
+    using BPlusTree = ::BPlusTree<T, Fanout, std::pmr::polymorphic_allocator<T>>;
+}
+
+#endif //BINARY_SEARCH_TREES_BPLUS_H
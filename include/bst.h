@@ -6,39 +6,109 @@
 #include <stack>
 #include <string>
 #include <stdexcept>
-#include <iostream>
-
-class DuplicateElement : std::exception {};
-
-class TreeEmptyException : std::exception {
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <algorithm>
+#include <cstdint>
+#include "bloom.h"
+
+// Tree-level node access (at, root, back, pop) is bounds- and emptiness-checked only in debug builds, or when
+// BST_VALIDATE is defined. Node navigation never is: a node reaches its relatives by index from its own slot.
+#if !defined(NDEBUG) || defined(BST_VALIDATE)
+inline constexpr bool bst_checked = true;
+#else
+inline constexpr bool bst_checked = false;
+#endif
+
+inline void bst_prefetch(const void *address) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#endif
+}
+
+class DuplicateElement : public std::exception {
 public:
-    explicit TreeEmptyException(std::string instruction = "") : instruction(std::move(instruction)) {
-        std::cerr<<"Tree is empty, cannot execute '" + this->instruction + "'\n";
+    [[nodiscard]] const char *what() const noexcept override {
+        return "Element already exists";
     }
-    const char* what() {
-        return ("Tree is empty, cannot execute '" + this->instruction + "'").c_str();
+};
+
+class TreeEmptyException : public std::exception {
+public:
+    explicit TreeEmptyException(const std::string &instruction = "")
+            : message("Tree is empty, cannot execute '" + instruction + "'") {}
+    [[nodiscard]] const char *what() const noexcept override {
+        return this->message.c_str();
     }
 private:
-    std::string instruction;
+    std::string message;
 };
 
-template <typename T>
+template <typename T, typename Allocator = std::allocator<T>>
 class BinarySearchTree {
 protected:
     class Node;
 public:
     class Iterator;
+    class Cursor;
     using iterator = Iterator;
-    BinarySearchTree();
-    virtual iterator insert(const T &value);
+    using value_type = T;
+    using allocator_type = Allocator;
+    explicit BinarySearchTree(const Allocator &allocator = Allocator());
+    // Nodes hold no pointer back to the tree: a copy is one bulk copy of the node vector and a move hands the vector
+    // over in O(1). The moved-from tree is left empty and usable.
+    BinarySearchTree(const BinarySearchTree &other) = default;
+    BinarySearchTree(BinarySearchTree &&other);
+    BinarySearchTree &operator=(const BinarySearchTree &other) = default;
+    BinarySearchTree &operator=(BinarySearchTree &&other);
+    // Like std::set: an equal key leaves the tree untouched and comes back with `false`.
+    virtual std::pair<iterator, bool> insert(const T &value);
+    virtual iterator insert(iterator hint, const T &value);
     virtual void remove(const T &value);
     virtual iterator find(const T &value);
     iterator predecessor_find(const T &value);
     iterator successor_find(const T &value);
+    // Equal keys become separate nodes placed after the existing ones; remove() takes out one of them.
+    void enable_multiset();
+    [[nodiscard]] bool is_multiset() const;
+    [[nodiscard]] size_t count(const T &value);
+    std::pair<iterator, iterator> equal_range(const T &value);
+    // Counting Bloom filter in front of find() and contains(), so most misses cost a hash instead of a descent.
+    // It is sized for max(expected_size, size()) keys and rebuilt at twice that once the tree outgrows it. Only
+    // trees of hashable values can enable it; for the others the filter checks compile away.
+    void enable_filter(double false_positive_rate = .01, size_t expected_size = 0) requires Hashable<T>;
+    void disable_filter();
+    [[nodiscard]] bool has_filter() const;
+    [[nodiscard]] size_t filter_memory() const;     // bytes held by the filter counters, 0 when disabled
+    [[nodiscard]] bool contains(const T &value);
+    [[nodiscard]] size_t depth(const T &value) const;      // nodes on the path to value, 0 when it is absent
+    Cursor cursor();
+    // Double-ended priority queue access. The leftmost and rightmost nodes are cached, so min() and max() are O(1)
+    // (amortized O(1) with lazy deletion, which may have to step over dead extremes). pop_min() and pop_max() cost
+    // one remove(): O(log n) for AVL and red-black trees, amortized O(log n) for scapegoat and splay trees. All four
+    // throw TreeEmptyException on an empty tree.
+    [[nodiscard]] const T &min();
+    [[nodiscard]] const T &max();
+    T pop_min();
+    T pop_max();
+    // Whole-tree scans over live values in one pass with an explicit stack, without per-step iterator climbs.
+    template <typename Function>
+    void for_each(Function fn) const;
+    // Visits every live value exactly once but in no particular order; fn is called from several threads at once.
+    template <typename Function>
+    void parallel_for_each(Function fn, size_t threads = std::thread::hardware_concurrency()) const;
+    size_t copy_to(std::span<T> out) const;     // the smallest out.size() values, returns how many were written
+    [[nodiscard]] std::vector<T, Allocator> to_vector() const;
     [[nodiscard]] size_t size() const;
+    [[nodiscard]] allocator_type get_allocator() const;
     virtual ~BinarySearchTree() = default;
-    virtual iterator begin();
-    virtual iterator end();
+    iterator begin();
+    iterator end();
 public:
     class Iterator {
     public:
@@ -65,76 +135,124 @@ public:
 
         explicit Iterator(Node &node);
     protected:
+        friend BinarySearchTree;
         Node *node;
         PointerType ptr;
-    private:
-        Node &find_next_node();
-        Node &find_prev_node();
+    protected:
+        Node &find_next_node() noexcept;
+        Node &find_prev_node() noexcept;
     };
 protected:
     class Node {
     public:
         friend iterator;
+        friend BinarySearchTree;
         Node(
                 size_t node_index,
                 const T &value,
-                BinarySearchTree *p_bst,
                 size_t parent_index = 0,
                 size_t left_index = 0,
                 size_t right_index = 0);
-        const Node &left() const;
-        Node &left();
-        const Node &right() const;
-        Node &right();
-        const Node &parent() const;
-        Node &parent();
-        const Node &sibling() const;
-        Node &sibling();
+        const Node &left() const noexcept;
+        Node &left() noexcept;
+        const Node &right() const noexcept;
+        Node &right() noexcept;
+        const Node &parent() const noexcept;
+        Node &parent() noexcept;
+        const Node &sibling() const noexcept;
+        Node &sibling() noexcept;
         void insert_child(Node &child, bool left);
-        [[nodiscard]] bool is_left_sibling() const;
-        [[nodiscard]] bool is_right_sibling() const;
-        [[nodiscard]] bool has_left() const;
-        [[nodiscard]] bool has_right() const;
-        [[nodiscard]] bool has_sibling() const;
+        [[nodiscard]] bool is_left_sibling() const noexcept;
+        [[nodiscard]] bool is_right_sibling() const noexcept;
+        [[nodiscard]] bool has_left() const noexcept;
+        [[nodiscard]] bool has_right() const noexcept;
+        [[nodiscard]] bool has_sibling() const noexcept;
         void update_indexes(size_t deleted_index);
-        [[nodiscard]] size_t get_node_index() const;
-        [[nodiscard]] size_t get_left_index() const;
-        [[nodiscard]] size_t get_right_index() const;
-        [[nodiscard]] size_t get_parent_index() const;
-        void set_left_index(size_t index);
-        void set_node_index(size_t index);
-        void set_right_index(size_t index);
-        void set_parent_index(size_t index);
+        [[nodiscard]] size_t get_node_index() const noexcept;
+        [[nodiscard]] size_t get_left_index() const noexcept;
+        [[nodiscard]] size_t get_right_index() const noexcept;
+        [[nodiscard]] size_t get_parent_index() const noexcept;
+        void set_left_index(size_t index) noexcept;
+        void set_node_index(size_t index) noexcept;
+        void set_right_index(size_t index) noexcept;
+        void set_parent_index(size_t index) noexcept;
         void set_value(const T &index);
         [[nodiscard]] T get_value() const;
-        [[nodiscard]] bool is_end_node() const;
+        [[nodiscard]] bool is_end_node() const noexcept;
+        [[nodiscard]] bool is_red() const noexcept;
+        void set_red(bool red) noexcept;
+        [[nodiscard]] bool is_dead() const noexcept;
+        void set_dead(bool dead) noexcept;
     private:
-        BinarySearchTree *p_bst;
         size_t node_index;
         size_t left_index;
         size_t right_index;
         size_t parent_index;
         T value;
+        bool red = false;
+        bool dead = false;
+    private:
+        // Nodes sit in tree_container at their own index, so the container starts node_index slots back.
+        const Node &relative(size_t index) const noexcept;
+        Node &relative(size_t index) noexcept;
     };
 protected:
+    // Steps over every node, including the dead ones the public iterator skips.
     class RestrictedIterator : public Iterator {
     public:
         explicit RestrictedIterator(Node &node);
         Node &get_node();
+        RestrictedIterator &operator++();
+        RestrictedIterator operator++(int);
+        RestrictedIterator &operator--();
+        RestrictedIterator operator--(int);
     };
     using restricted_iterator = RestrictedIterator;
+public:
+    // Finger into the tree: every call starts where the previous one ended and climbs through parent() only until
+    // the target has to lie below, so nearby keys cost about the log of their rank distance instead of log n.
+    // Any node is a valid starting point, so the cursor survives inserts and removals elsewhere in the tree.
+    class Cursor {
+    public:
+        iterator seek(const T &value);      // first value not less than value, like successor_find
+        iterator find(const T &value);
+        std::pair<iterator, bool> insert(const T &value);
+    private:
+        friend BinarySearchTree;
+        explicit Cursor(BinarySearchTree &tree);
+        BinarySearchTree *tree;
+        size_t finger = 0;
+    private:
+        restricted_iterator locate(const T &value);
+    };
 protected:
+    template <typename U>
+    using rebind_alloc = typename std::allocator_traits<Allocator>::template rebind_alloc<U>;
+    template <typename U>
+    using vector = std::vector<U, rebind_alloc<U>>;
+    template <typename U>
+    using stack = std::stack<U, vector<U>>;
+protected:
+    size_t dead_count = 0;
+    bool multiset = false;
+    bool filtered = false;
+    CountingBloomFilter<T, Allocator> filter;
+    bool augmented = false;     // update_path() only walks when a subclass keeps per-node data
+protected:
+    [[nodiscard]] size_t node_count() const;
     [[nodiscard]] size_t next_index() const;
-    const Node &at(size_t index) const;
-    Node &at(size_t index);
-    const Node &back() const;
-    Node &back();
+    const Node &at(size_t index) const noexcept(!bst_checked);
+    Node &at(size_t index) noexcept(!bst_checked);
+    const Node &back() const noexcept(!bst_checked);
+    Node &back() noexcept(!bst_checked);
     restricted_iterator lookup(const T &value);
+    restricted_iterator find_lower_bound(const T &value);
+    restricted_iterator find_lower_bound(const T &value, Node &from);
     [[nodiscard]] bool empty() const;
     size_t size(const Node &node) const;
-    [[nodiscard]] size_t size(size_t index) const;
-    const Node &root() const;
-    Node &root();
+    [[nodiscard]] size_t size(size_t index, size_t limit = SIZE_MAX) const;     // stops counting past limit
+    const Node &root() const noexcept(!bst_checked);
+    Node &root() noexcept(!bst_checked);
     void pop(size_t index);
     void pop(const Node &node);
     void push(const Node &node);
@@ -145,23 +263,61 @@ protected:
             size_t left_index = 0,
             size_t right_index = 0) const;
     void emplace(const T &value, size_t parent_index = 0, size_t left_index = 0, size_t right_index = 0);
+    struct InsertPosition {
+        Node *node;     // parent for the new value, or the node already holding it
+        bool left;
+        bool exists;
+    };
+    InsertPosition find_insert_position(const T &value);
+    InsertPosition find_insert_position(iterator hint, const T &value);
+    Node &attach(Node &parent, bool left, const T &value);
+    // Keeps the cached leftmost and rightmost nodes valid; called before a node with at most one child is unlinked.
+    // detach() does it already.
+    void unlink_extremes(const Node &node);
+    void refresh_extremes();
+    // Engines call these whenever a value logically enters or leaves the tree outside of attach().
+    void filter_insert(const T &value);
+    void filter_remove(const T &value);
+    [[nodiscard]] bool filter_excludes(const T &value) const;
     void remove_node_no_children(Node &node);
     void remove_node_one_child(Node &node);
+    // Unlinks a node with at most one child and returns the index its parent holds afterwards.
+    size_t detach(Node &node);
+    // Per-node data hooks: update_node recomputes a node from its children, swap_nodes runs whenever two indices
+    // trade their nodes (pop() moving the back node into a freed index, relocate()), and update_path refreshes a
+    // node and all its ancestors.
+    virtual void update_node(Node &node);
+    virtual void swap_nodes(size_t first, size_t second);
+    void update_path(Node &node);
+    static Node &node_of(const iterator &it) noexcept;
+    // Trades all nodes with other in O(1); the filter, the flags and per-node data kept by subclasses stay put.
+    void exchange_nodes(BinarySearchTree &other) noexcept;
+    void reserve_nodes(size_t count);
+    // Stores the node at index order[k] at index k + 1 and rewrites every link; order lists each node once.
+    void relocate(const vector<size_t> &order);
+    // Runs task(0) ... task(tasks - 1) on up to `threads` threads, the calling one included. The first exception
+    // stops further claims and is rethrown once every thread has joined.
+    template <typename Function>
+    static void parallel_run(size_t tasks, size_t threads, Function task);
 private:
-    std::vector<Node> tree_container;
+    vector<Node> tree_container;
+    size_t min_index = 0;       // leftmost node, dead or alive, 0 when empty
+    size_t max_index = 0;       // rightmost node, dead or alive, 0 when empty
+    static constexpr size_t parallel_min_size = 1 << 14;    // below this, starting threads costs more than the scan
 private:
-    Node &find_min();
+    template <typename Visitor>
+    bool walk(size_t index, Visitor &visit) const;
 };
 
-template<typename T>
-void BinarySearchTree<T>::remove_node_no_children(Node &node) {
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::remove_node_no_children(Node &node) {
     if(node.is_left_sibling()) node.parent().set_left_index(0);
     else node.parent().set_right_index(0);
     this->pop(node);
 }
 
-template<typename T>
-void BinarySearchTree<T>::remove_node_one_child(Node &node) {
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::remove_node_one_child(Node &node) {
     Node &parent = node.parent();
     Node &child = node.has_right() ? node.right() : node.left();
     if(node.is_right_sibling()) {
@@ -174,80 +330,223 @@ void BinarySearchTree<T>::remove_node_one_child(Node &node) {
     this->pop(node);
 }
 
-template<typename T>
-void BinarySearchTree<T>::Node::set_node_index(size_t index) {
+// pop() moves the back node into the freed index, so the parent is resolved beforehand.
+template<typename T, typename Allocator>
+size_t BinarySearchTree<T, Allocator>::detach(Node &node) {
+    size_t index = node.get_node_index();
+    size_t parent_index = node.get_parent_index();
+    if(parent_index == this->back().get_node_index()) parent_index = index;
+    this->unlink_extremes(node);
+    if(!node.has_left() && !node.has_right()) this->remove_node_no_children(node);
+    else this->remove_node_one_child(node);
+    return parent_index;
+}
+
+// The leftmost node has no left child, so its successor is the leftmost node of its right subtree, or else its
+// parent; the rightmost node mirrors that.
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::unlink_extremes(const Node &node) {
+    size_t index = node.get_node_index();
+    if(index == this->min_index) {
+        if(!node.has_right()) this->min_index = node.get_parent_index();
+        else {
+            const Node *next = &node.right();
+            while(next->has_left()) next = &next->left();
+            this->min_index = next->get_node_index();
+        }
+    }
+    if(index == this->max_index) {
+        if(!node.has_left()) this->max_index = node.get_parent_index();
+        else {
+            const Node *prev = &node.left();
+            while(prev->has_right()) prev = &prev->right();
+            this->max_index = prev->get_node_index();
+        }
+    }
+}
+
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::refresh_extremes() {
+    this->min_index = this->max_index = 0;
+    if(this->empty()) return;
+    const Node *node = &this->root();
+    while(node->has_left()) node = &node->left();
+    this->min_index = node->get_node_index();
+    node = &this->root();
+    while(node->has_right()) node = &node->right();
+    this->max_index = node->get_node_index();
+}
+
+template<typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::node_of(const iterator &it) noexcept {
+    return *it.node;
+}
+
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::exchange_nodes(BinarySearchTree &other) noexcept {
+    std::swap(this->tree_container, other.tree_container);
+    std::swap(this->min_index, other.min_index);
+    std::swap(this->max_index, other.max_index);
+    std::swap(this->dead_count, other.dead_count);
+}
+
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::reserve_nodes(size_t count) {
+    this->tree_container.reserve(count + 1);
+}
+
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::relocate(const vector<size_t> &order) {
+    size_t count = this->node_count();
+    vector<size_t> new_index(count + 1, 0, this->tree_container.get_allocator());
+    vector<size_t> position(count + 1, 0, this->tree_container.get_allocator());    // by original index
+    vector<size_t> occupant(count + 1, 0, this->tree_container.get_allocator());    // original index, by slot
+    for(size_t i = 0; i <= count; i++) position[i] = occupant[i] = i;
+    for(size_t k = 0; k < count; k++) new_index[order[k]] = k + 1;
+    for(size_t target = 1; target <= count; target++) {
+        size_t wanted = order[target - 1], source = position[wanted];
+        if(source == target) continue;
+        this->swap_nodes(target, source);
+        std::swap(this->tree_container[target], this->tree_container[source]);
+        size_t displaced = occupant[target];
+        occupant[source] = displaced;
+        position[displaced] = source;
+        occupant[target] = wanted;
+        position[wanted] = target;
+    }
+    for(size_t i = 0; i <= count; i++) {
+        Node &node = this->tree_container[i];
+        node.set_node_index(i);
+        node.set_left_index(new_index[node.get_left_index()]);
+        node.set_right_index(new_index[node.get_right_index()]);
+        node.set_parent_index(new_index[node.get_parent_index()]);
+    }
+    this->min_index = new_index[this->min_index];
+    this->max_index = new_index[this->max_index];
+}
+
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::update_node(Node &) {}
+
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::swap_nodes(size_t, size_t) {}
+
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::update_path(Node &node) {
+    if(!this->augmented) return;
+    for(Node *current = &node; !current->is_end_node(); current = &current->parent()) this->update_node(*current);
+}
+
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::Node::set_node_index(size_t index) noexcept {
     this->node_index = index;
 }
 
-template<typename T>
-void BinarySearchTree<T>::remove(const T &value) {
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::remove(const T &value) {
     restricted_iterator it = this->lookup(value);
     if(it == this->end()) return;
-    Node &node = it.get_node();
-    if(!node.has_left() && !node.has_right()) {
-        this->remove_node_no_children(node);
-    }
-    else if(!node.has_left() || !node.has_right()) {
-        this->remove_node_one_child(node);
-    }
-    else {
-        Node *current_node = &node;
-        while(true) {
-            it++;
-            Node &next = it.get_node();
-            current_node->set_value(next.get_value());
-            if(!next.has_right() && !next.has_left()) {
-                this->remove_node_no_children(next);
-                break;
-            }
-            else if(!next.has_right() || !next.has_left()) {
-                this->remove_node_one_child(next);
-                break;
-            }
-            else current_node = &next;
-        }
+    this->filter_remove(value);
+    Node *node = &it.get_node();
+    if(node->has_left() && node->has_right()) {
+        it++;
+        Node &next = it.get_node();
+        node->set_value(next.get_value());
+        node = &next;
     }
+    this->update_path(this->at(this->detach(*node)));
 }
 
-template<typename T>
-BinarySearchTree<T>::iterator BinarySearchTree<T>::insert(const T &value) {
-    if(this->empty()) {
-        this->emplace(value);
-        return this->begin();
-    }
+template<typename T, typename Allocator>
+std::pair<typename BinarySearchTree<T, Allocator>::iterator, bool> BinarySearchTree<T, Allocator>::insert(const T &value) {
+    auto [parent, left, exists] = this->find_insert_position(value);
+    if(exists) return {iterator(*parent), false};
+    return {iterator(this->attach(*parent, left, value)), true};
+}
+
+template<typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::iterator BinarySearchTree<T, Allocator>::insert(iterator hint, const T &value) {
+    auto [parent, left, exists] = this->find_insert_position(hint, value);
+    if(exists) return iterator(*parent);
+    return iterator(this->attach(*parent, left, value));
+}
+
+template<typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::InsertPosition
+BinarySearchTree<T, Allocator>::find_insert_position(const T &value) {
+    if(this->empty()) return {&this->at(0), true, false};
 
     Node *node = &this->root();
 
     while(true) {
         if(value < node->get_value()) {
-            if(!node->has_left()) {
-                node->set_left_index(this->next_index());
-                this->emplace(value, node->get_node_index());
-                break;
-            }
+            if(!node->has_left()) return {node, true, false};
             node = &node->left();
         }
-        else if(value > node->get_value()) {
-            if(!node->has_right()) {
-                node->set_right_index(this->next_index());
-                this->emplace(value, node->get_node_index());
-                break;
-            }
+        else if(this->multiset || value > node->get_value()) {
+            if(!node->has_right()) return {node, false, false};
             node = &node->right();
         }
-        else throw DuplicateElement();
+        else return {node, false, true};
     }
+}
 
-    return iterator(this->back());
+// Mirrors std::set::emplace_hint: the hint is used when the value belongs right before or right after it,
+// otherwise the search falls back to a descent from the root. In a multiset, equal neighbours also qualify.
+template<typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::InsertPosition
+BinarySearchTree<T, Allocator>::find_insert_position(iterator hint, const T &value) {
+    Node &node = *hint.node;
+    if(node.is_end_node()) {
+        restricted_iterator before = restricted_iterator(this->at(this->max_index));
+        if(!before.get_node().is_end_node() && (*before < value || (this->multiset && !(value < *before)))) {
+            return {&before.get_node(), false, false};
+        }
+        return this->find_insert_position(value);
+    }
+    if(value < node.get_value() || (this->multiset && !(node.get_value() < value))) {
+        restricted_iterator before = restricted_iterator(node);
+        --before;
+        if(before.get_node().is_end_node() || *before < value || (this->multiset && !(value < *before))) {
+            if(!node.has_left()) return {&node, true, false};
+            return {&before.get_node(), false, false};
+        }
+    }
+    else if(value > node.get_value()) {
+        restricted_iterator after = restricted_iterator(node);
+        ++after;
+        if(after.get_node().is_end_node() || value < *after || (this->multiset && !(*after < value))) {
+            if(!node.has_right()) return {&node, false, false};
+            return {&after.get_node(), true, false};
+        }
+    }
+    else return {&node, false, true};
+    return this->find_insert_position(value);
 }
 
-template<typename T>
-BinarySearchTree<T>::iterator BinarySearchTree<T>::find(const T &value) {
-    return this->lookup(value);
+template<typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::attach(Node &parent, bool left, const T &value) {
+    this->filter_insert(value);
+    size_t index = this->next_index(), parent_index = parent.get_node_index();
+    if(left) parent.set_left_index(index);
+    else parent.set_right_index(index);
+    if(parent_index == 0) this->min_index = this->max_index = index;
+    else if(left && parent_index == this->min_index) this->min_index = index;
+    else if(!left && parent_index == this->max_index) this->max_index = index;
+    this->emplace(value, parent_index);
+    return this->back();
 }
 
-template<typename T>
-BinarySearchTree<T>::restricted_iterator BinarySearchTree<T>::lookup(const T &value) {
+template<typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::iterator BinarySearchTree<T, Allocator>::find(const T &value) {
+    if(this->filter_excludes(value)) return this->end();
+    iterator it = this->successor_find(value);
+    if(it == this->end() || value < *it) return this->end();
+    return it;
+}
+
+template<typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::restricted_iterator BinarySearchTree<T, Allocator>::lookup(const T &value) {
     if(this->empty()) return restricted_iterator(this->at(0));
 
     Node *node = &this->root();
@@ -260,56 +559,142 @@ BinarySearchTree<T>::restricted_iterator BinarySearchTree<T>::lookup(const T &va
     return restricted_iterator(*node);
 }
 
-template<typename T>
-size_t BinarySearchTree<T>::next_index() const {
-    return this->size() + 1;
+// First node, dead or alive, that is not less than value. In a set the descent stops at an equal key.
+template<typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::restricted_iterator BinarySearchTree<T, Allocator>::find_lower_bound(const T &value) {
+    if(this->empty()) return restricted_iterator(this->at(0));
+    return this->find_lower_bound(value, this->root());
+}
+
+// Same result, starting from an arbitrary node. Going up stops at the first ancestor reached from the side the
+// value lies on: its value bounds the answer, so the rest of the search stays inside the child's subtree.
+template<typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::restricted_iterator
+BinarySearchTree<T, Allocator>::find_lower_bound(const T &value, Node &from) {
+    if(this->empty()) return restricted_iterator(this->at(0));
+
+    Node *node = from.is_end_node() ? &this->root() : &from;
+    Node *potential = &this->at(0);
+    bool right = node->get_value() < value;
+    if(!right && !this->multiset && !(value < node->get_value())) return restricted_iterator(*node);
+    while(!node->parent().is_end_node()) {
+        Node &parent = node->parent();
+        if(right && node->is_left_sibling() && !(parent.get_value() < value)) {
+            potential = &parent;
+            break;
+        }
+        if(!right && node->is_right_sibling() && parent.get_value() < value) break;
+        node = &parent;
+    }
+    while(true) {
+        if(node->get_value() < value) {
+            if(!node->has_right()) break;
+            node = &node->right();
+        }
+        else {
+            potential = node;
+            if(!this->multiset && !(value < node->get_value())) break;
+            if(!node->has_left()) break;
+            node = &node->left();
+        }
+    }
+    return restricted_iterator(*potential);
+}
+
+template<typename T, typename Allocator>
+size_t BinarySearchTree<T, Allocator>::next_index() const {
+    return this->node_count() + 1;
 }
 
-template<typename T>
-typename BinarySearchTree<T>::Node &BinarySearchTree<T>::at(size_t index) {
-    if(index > this->size()) throw std::out_of_range(
-                "Provided index for 'at' (" +
-                std::to_string(index) +
-                ") is out of range (" +
-                std::to_string(this->size()) +
-                ")"
-        );
-    return this->tree_container.at(index);
+template<typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::at(size_t index) noexcept(!bst_checked) {
+    if constexpr(bst_checked) {
+        if(index > this->node_count()) throw std::out_of_range(
+                    "Provided index for 'at' (" +
+                    std::to_string(index) +
+                    ") is out of range (" +
+                    std::to_string(this->node_count()) +
+                    ")"
+            );
+    }
+    return this->tree_container[index];
+}
+
+template <typename T, typename Allocator>
+size_t BinarySearchTree<T, Allocator>::size() const {
+    return this->node_count() - this->dead_count;
 }
 
-template <typename T>
-size_t BinarySearchTree<T>::size() const {
+template <typename T, typename Allocator>
+size_t BinarySearchTree<T, Allocator>::node_count() const {
     return this->tree_container.size() - 1;
 }
 
-template <typename T>
-const typename BinarySearchTree<T>::Node &BinarySearchTree<T>::at(size_t index) const {
-    if(index > this->size()) throw std::out_of_range(
-                "Provided index for 'at' (" +
-                std::to_string(index) +
-                ") is out of range (" +
-                std::to_string(this->size()) +
-                ")"
-        );
-    return this->tree_container.at(index);
+template <typename T, typename Allocator>
+const typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::at(size_t index) const noexcept(!bst_checked) {
+    if constexpr(bst_checked) {
+        if(index > this->node_count()) throw std::out_of_range(
+                    "Provided index for 'at' (" +
+                    std::to_string(index) +
+                    ") is out of range (" +
+                    std::to_string(this->node_count()) +
+                    ")"
+            );
+    }
+    return this->tree_container[index];
+}
+
+template <typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::BinarySearchTree(const Allocator &allocator) : filter(allocator), tree_container(allocator) {
+    this->emplace({});
+}
+
+template <typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::BinarySearchTree(BinarySearchTree &&other)
+        : dead_count(std::exchange(other.dead_count, 0)),
+          multiset(other.multiset),
+          filtered(std::exchange(other.filtered, false)),
+          filter(std::move(other.filter)),
+          augmented(other.augmented),
+          tree_container(std::move(other.tree_container)),
+          min_index(std::exchange(other.min_index, 0)),
+          max_index(std::exchange(other.max_index, 0)) {
+    other.tree_container.clear();
+    other.emplace({});
+}
+
+template <typename T, typename Allocator>
+BinarySearchTree<T, Allocator> &BinarySearchTree<T, Allocator>::operator=(BinarySearchTree &&other) {
+    if(this == &other) return *this;
+    this->dead_count = std::exchange(other.dead_count, 0);
+    this->multiset = other.multiset;
+    this->filtered = std::exchange(other.filtered, false);
+    this->filter = std::move(other.filter);
+    this->augmented = other.augmented;
+    this->tree_container = std::move(other.tree_container);
+    this->min_index = std::exchange(other.min_index, 0);
+    this->max_index = std::exchange(other.max_index, 0);
+    other.tree_container.clear();
+    other.emplace({});
+    return *this;
 }
 
-template <typename T>
-BinarySearchTree<T>::BinarySearchTree() {
-    this->emplace({}, 0, 1);
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::allocator_type BinarySearchTree<T, Allocator>::get_allocator() const {
+    return Allocator(this->tree_container.get_allocator());
 }
 
-template <typename T>
-size_t BinarySearchTree<T>::size(const Node &node) const {
+template <typename T, typename Allocator>
+size_t BinarySearchTree<T, Allocator>::size(const Node &node) const {
     return this->size(node.get_node_index());
 }
 
-template <typename T>
-size_t BinarySearchTree<T>::size(size_t index) const {
-    std::stack<size_t> s;
+template <typename T, typename Allocator>
+size_t BinarySearchTree<T, Allocator>::size(size_t index, size_t limit) const {
+    stack<size_t> s(vector<size_t>(this->tree_container.get_allocator()));
     s.push(index);
     size_t result = 0;
-    while(!s.empty()) {
+    while(!s.empty() && result <= limit) {
         result++;
         index = s.top();
         s.pop();
@@ -320,11 +705,10 @@ size_t BinarySearchTree<T>::size(size_t index) const {
     return result;
 }
 
-template<typename T>
-BinarySearchTree<T>::Node::Node(
+template<typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::Node::Node(
         size_t node_index,
         const T &value,
-        BinarySearchTree *p_bst,
         size_t parent_index,
         size_t left_index,
         size_t right_index)
@@ -333,110 +717,119 @@ BinarySearchTree<T>::Node::Node(
         parent_index(parent_index),
         value(value),
         left_index(left_index),
-        right_index(right_index),
-        p_bst(p_bst) {
-    if(!p_bst) throw std::exception();
-}
+        right_index(right_index) {}
 
-template<typename T>
-size_t BinarySearchTree<T>::Node::get_node_index() const {
+template<typename T, typename Allocator>
+size_t BinarySearchTree<T, Allocator>::Node::get_node_index() const noexcept {
     return this->node_index;
 }
 
-template<typename T>
-size_t BinarySearchTree<T>::Node::get_parent_index() const {
+template<typename T, typename Allocator>
+size_t BinarySearchTree<T, Allocator>::Node::get_parent_index() const noexcept {
     return this->parent_index;
 }
 
-template<typename T>
-size_t BinarySearchTree<T>::Node::get_left_index() const {
+template<typename T, typename Allocator>
+size_t BinarySearchTree<T, Allocator>::Node::get_left_index() const noexcept {
     return this->left_index;
 }
 
-template<typename T>
-size_t BinarySearchTree<T>::Node::get_right_index() const {
+template<typename T, typename Allocator>
+size_t BinarySearchTree<T, Allocator>::Node::get_right_index() const noexcept {
     return this->right_index;
 }
 
-template<typename T>
-T BinarySearchTree<T>::Node::get_value() const {
+template<typename T, typename Allocator>
+T BinarySearchTree<T, Allocator>::Node::get_value() const {
     return this->value;
 }
 
-template<typename T>
-void BinarySearchTree<T>::Node::update_indexes(size_t deleted_index) {
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::Node::update_indexes(size_t deleted_index) {
     if(this->node_index > deleted_index) this->node_index--;
     if(left_index > deleted_index) left_index--;
     if(right_index > deleted_index) right_index--;
     if(parent_index > deleted_index) parent_index--;
 }
 
-template<typename T>
-void BinarySearchTree<T>::Node::set_left_index(size_t index) {
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::Node::set_left_index(size_t index) noexcept {
     this->left_index = index;
 }
 
-template<typename T>
-void BinarySearchTree<T>::Node::set_parent_index(size_t index) {
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::Node::set_parent_index(size_t index) noexcept {
     this->parent_index = index;
 }
 
-template<typename T>
-void BinarySearchTree<T>::Node::set_right_index(size_t index) {
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::Node::set_right_index(size_t index) noexcept {
     this->right_index = index;
 }
 
-template<typename T>
-const typename BinarySearchTree<T>::Node &BinarySearchTree<T>::Node::left() const {
-    return this->p_bst->at(this->left_index);
+template<typename T, typename Allocator>
+const typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::Node::left() const noexcept {
+    return this->relative(this->left_index);
 }
 
-template<typename T>
-bool BinarySearchTree<T>::Node::has_left() const {
+template<typename T, typename Allocator>
+const typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::Node::relative(size_t index) const noexcept {
+    return (this - this->node_index)[index];
+}
+
+template<typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::Node::relative(size_t index) noexcept {
+    return (this - this->node_index)[index];
+}
+
+template<typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::Node::has_left() const noexcept {
     return this->left_index != 0;
 }
 
-template<typename T>
-bool BinarySearchTree<T>::Node::has_right() const {
+template<typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::Node::has_right() const noexcept {
     return this->right_index != 0;
 }
 
-template<typename T>
-void BinarySearchTree<T>::Node::insert_child(Node &child, bool left) {
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::Node::insert_child(Node &child, bool left) {
     child.parent_index = this->node_index;
     if(left) this->left_index = child.node_index;
     else this->right_index = child.node_index;
 }
 
-template<typename T>
-const typename BinarySearchTree<T>::Node &BinarySearchTree<T>::Node::parent() const {
-    return this->p_bst->at(this->parent_index);
+template<typename T, typename Allocator>
+const typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::Node::parent() const noexcept {
+    return this->relative(this->parent_index);
 }
 
-template<typename T>
-bool BinarySearchTree<T>::Node::is_left_sibling() const {
+template<typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::Node::is_left_sibling() const noexcept {
     return this->parent().left_index == this->node_index;
 }
 
-template<typename T>
-bool BinarySearchTree<T>::Node::is_right_sibling() const {
+template<typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::Node::is_right_sibling() const noexcept {
     return this->parent().right_index == this->node_index;
 }
 
-template<typename T>
-const typename BinarySearchTree<T>::Node &BinarySearchTree<T>::Node::right() const {
-    return this->p_bst->at(this->right_index);
+template<typename T, typename Allocator>
+const typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::Node::right() const noexcept {
+    return this->relative(this->right_index);
 }
 
-template<typename T>
-void BinarySearchTree<T>::pop(size_t index) {
-    if(index > this->size()) throw std::out_of_range(
-                std::string("Provided index for 'pop' (") +
-                std::to_string(index) +
-                ") is out of range (" +
-                std::to_string(this->size()) +
-                ")"
-        );
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::pop(size_t index) {
+    if constexpr(bst_checked) {
+        if(index > this->node_count()) throw std::out_of_range(
+                    std::string("Provided index for 'pop' (") +
+                    std::to_string(index) +
+                    ") is out of range (" +
+                    std::to_string(this->node_count()) +
+                    ")"
+            );
+    }
 //    for(size_t i = 1; i <= this->size(); i++) {
 //        this->at(i).update_indexes(index);
 //    }
@@ -445,52 +838,58 @@ void BinarySearchTree<T>::pop(size_t index) {
         this->tree_container.pop_back();
         return;
     }
+    size_t back_index = this->back().get_node_index();
+    this->swap_nodes(index, back_index);
+    if(this->min_index == back_index) this->min_index = index;
+    if(this->max_index == back_index) this->max_index = index;
     Node &node = this->at(index);
     std::swap(node, this->back());
-    if(node.is_left_sibling()) node.parent().set_left_index(index);
-    else node.parent().set_right_index(index);
-    node.set_node_index(index);
+    node.set_node_index(index);     // before any navigation, which is relative to the node's own index
+    Node &parent = node.parent();
+    if(parent.get_left_index() == back_index) parent.set_left_index(index);
+    else parent.set_right_index(index);
     if(node.has_left()) node.left().set_parent_index(index);
     if(node.has_right()) node.right().set_parent_index(index);
     this->tree_container.pop_back();
 }
 
-template<typename T>
-void BinarySearchTree<T>::pop(const Node &node) {
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::pop(const Node &node) {
     size_t index = node.get_node_index();
     this->pop(index);
 }
 
-template<typename T>
-void BinarySearchTree<T>::push(const Node &node) {
+template<typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::push(const Node &node) {
     tree_container.push_back(node);
-    if(this->size() == 0) {
-        this->tree_container.at(0).insert_child(this->back(), true);
+    if(this->node_count() == 0) {
+        this->tree_container[0].insert_child(this->back(), true);
     }
 }
 
-template<typename T>
-typename BinarySearchTree<T>::Node BinarySearchTree<T>::create_node(
+template<typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Node BinarySearchTree<T, Allocator>::create_node(
         size_t node_index,
         const T &value,
         size_t parent_index,
         size_t left_index,
         size_t right_index) const {
-    return Node(node_index, value, parent_index, this, left_index, right_index);
+    return Node(node_index, value, parent_index, left_index, right_index);
 }
 
-template <typename T>
-void BinarySearchTree<T>::emplace(const T &value, size_t parent_index, size_t left_index, size_t right_index) {
+template <typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::emplace(const T &value, size_t parent_index, size_t left_index, size_t right_index) {
     size_t node_index = 0;
     if(!this->tree_container.empty()) node_index = this->next_index();
-    this->tree_container.emplace_back(node_index, value, this, parent_index, left_index, right_index);
+    this->tree_container.emplace_back(node_index, value, parent_index, left_index, right_index);
+    if(node_index == 1) this->tree_container.front().set_left_index(1);
 }
 
-template <typename T>
-BinarySearchTree<T>::Iterator::Iterator(BinarySearchTree<T>::Node &node) : ptr(&node.value), node(&node) {}
+template <typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::Iterator::Iterator(BinarySearchTree<T, Allocator>::Node &node) : ptr(&node.value), node(&node) {}
 
-template <typename T>
-typename BinarySearchTree<T>::Node &BinarySearchTree<T>::iterator::find_next_node() {
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::iterator::find_next_node() noexcept {
     Node *node_it = this->node;
     if(node_it->has_right()) {
         node_it = &node_it->right();
@@ -509,8 +908,8 @@ typename BinarySearchTree<T>::Node &BinarySearchTree<T>::iterator::find_next_nod
     return node_it->parent();
 }
 
-template <typename T>
-typename BinarySearchTree<T>::Node &BinarySearchTree<T>::iterator::find_prev_node() {
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::iterator::find_prev_node() noexcept {
     Node *node_it = this->node;
     if(node_it->has_left()) {
         node_it = &node_it->left();
@@ -533,54 +932,54 @@ typename BinarySearchTree<T>::Node &BinarySearchTree<T>::iterator::find_prev_nod
     return *node_it;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::iterator &BinarySearchTree<T>::iterator::operator++(){
-    this->node = &this->find_next_node();
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::iterator &BinarySearchTree<T, Allocator>::iterator::operator++(){
+    do this->node = &this->find_next_node();
+    while(this->node->is_dead());
     this->ptr = &this->node->value;
     return *this;
 }
 
 
-template <typename T>
-typename BinarySearchTree<T>::iterator BinarySearchTree<T>::iterator::operator++(int) {
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::iterator BinarySearchTree<T, Allocator>::iterator::operator++(int) {
     iterator temp = *this;
-    this->node = &this->find_next_node();
-    this->ptr = &this->node->value;
+    ++*this;
     return temp;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::iterator::RefType BinarySearchTree<T>::iterator::operator*() const {
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::iterator::RefType BinarySearchTree<T, Allocator>::iterator::operator*() const {
     return *this->ptr;
 }
 
-template <typename T>
-bool BinarySearchTree<T>::iterator::operator==(const iterator &other) const {
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::iterator::operator==(const iterator &other) const {
     return this->node->node_index == other.node->node_index;
 }
 
-template <typename T>
-bool BinarySearchTree<T>::iterator::operator!=(const iterator &other) const {
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::iterator::operator!=(const iterator &other) const {
     return this->node->node_index != other.node->node_index;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::iterator &BinarySearchTree<T>::iterator::operator--() {
-    this->node = &this->find_prev_node();
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::iterator &BinarySearchTree<T, Allocator>::iterator::operator--() {
+    do this->node = &this->find_prev_node();
+    while(this->node->is_dead());
     this->ptr = &this->node->value;
     return *this;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::iterator BinarySearchTree<T>::iterator::operator--(int) {
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::iterator BinarySearchTree<T, Allocator>::iterator::operator--(int) {
     iterator temp = *this;
-    this->node = &this->find_prev_node();
-    this->ptr = &this->node->value;
+    --*this;
     return temp;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::iterator BinarySearchTree<T>::iterator::operator+(int n) const {
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::iterator BinarySearchTree<T, Allocator>::iterator::operator+(int n) const {
     iterator temp = *this;
     int sign = n > 0 ? 1 : -1;
     n = n > 0 ? n : -n;
@@ -591,200 +990,505 @@ typename BinarySearchTree<T>::iterator BinarySearchTree<T>::iterator::operator+(
     return temp;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::iterator BinarySearchTree<T>::iterator::operator-(int n) const {
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::iterator BinarySearchTree<T, Allocator>::iterator::operator-(int n) const {
     return *this + -n;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::iterator &BinarySearchTree<T>::iterator::operator+=(int n) {
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::iterator &BinarySearchTree<T, Allocator>::iterator::operator+=(int n) {
     *this = *this + n;
     return *this;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::iterator &BinarySearchTree<T>::iterator::operator-=(int n) {
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::iterator &BinarySearchTree<T, Allocator>::iterator::operator-=(int n) {
     return *this += -n;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::iterator BinarySearchTree<T>::begin() {
-    return iterator(this->find_min());
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::iterator BinarySearchTree<T, Allocator>::begin() {
+    iterator it(this->at(this->min_index));
+    if(it.node->is_dead()) ++it;
+    return it;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::iterator BinarySearchTree<T>::end() {
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::iterator BinarySearchTree<T, Allocator>::end() {
     return iterator(this->at(0));
 }
 
-template <typename T>
-typename BinarySearchTree<T>::Node &BinarySearchTree<T>::find_min() {
-    Node *node = &this->at(0);
-    while(true) {
-        if(!node->has_left()) return *node;
-        node = &node->left();
-    }
+template <typename T, typename Allocator>
+const T &BinarySearchTree<T, Allocator>::min() {
+    if(this->size() == 0) throw TreeEmptyException("min");
+    return *this->begin();
+}
+
+template <typename T, typename Allocator>
+const T &BinarySearchTree<T, Allocator>::max() {
+    if(this->size() == 0) throw TreeEmptyException("max");
+    iterator it(this->at(this->max_index));
+    if(it.node->is_dead()) --it;
+    return *it;
 }
 
-template <typename T>
-const typename BinarySearchTree<T>::Node &BinarySearchTree<T>::root() const {
-    if(this->empty()) throw TreeEmptyException("root");
+template <typename T, typename Allocator>
+T BinarySearchTree<T, Allocator>::pop_min() {
+    if(this->size() == 0) throw TreeEmptyException("pop_min");
+    T value = this->min();
+    this->remove(value);
+    return value;
+}
+
+template <typename T, typename Allocator>
+T BinarySearchTree<T, Allocator>::pop_max() {
+    if(this->size() == 0) throw TreeEmptyException("pop_max");
+    T value = this->max();
+    this->remove(value);
+    return value;
+}
+
+template <typename T, typename Allocator>
+const typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::root() const noexcept(!bst_checked) {
+    if constexpr(bst_checked) {
+        if(this->empty()) throw TreeEmptyException("root");
+    }
     return this->at(0).left();
 }
 
-template <typename T>
-typename BinarySearchTree<T>::Node &BinarySearchTree<T>::root() {
-    if(this->empty()) throw TreeEmptyException("root");
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::root() noexcept(!bst_checked) {
+    if constexpr(bst_checked) {
+        if(this->empty()) throw TreeEmptyException("root");
+    }
     return this->at(0).left();
 }
 
-template <typename T>
-const typename BinarySearchTree<T>::Node &BinarySearchTree<T>::back() const {
-    if(this->empty()) throw TreeEmptyException("back");
-    return this->at(this->size());
+template <typename T, typename Allocator>
+const typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::back() const noexcept(!bst_checked) {
+    if constexpr(bst_checked) {
+        if(this->empty()) throw TreeEmptyException("back");
+    }
+    return this->at(this->node_count());
 }
 
-template <typename T>
-typename BinarySearchTree<T>::Node &BinarySearchTree<T>::back() {
-    if(this->empty()) throw TreeEmptyException("back");
-    return this->at(this->size());
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::back() noexcept(!bst_checked) {
+    if constexpr(bst_checked) {
+        if(this->empty()) throw TreeEmptyException("back");
+    }
+    return this->at(this->node_count());
 }
 
-template <typename T>
-bool BinarySearchTree<T>::empty() const {
-    return this->size() == 0;
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::empty() const {
+    return this->node_count() == 0;
 }
 
-template <typename T>
-bool BinarySearchTree<T>::Node::has_sibling() const {
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::Node::has_sibling() const noexcept {
     if(this->is_left_sibling()) return this->parent().right_index != 0;
     else return this->parent().left_index != 0;
 }
 
-template <typename T>
-const typename BinarySearchTree<T>::Node &BinarySearchTree<T>::Node::sibling() const {
+template <typename T, typename Allocator>
+const typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::Node::sibling() const noexcept {
     if(this->is_left_sibling()) return this->parent().right();
     else return this->parent().left();
 }
 
-template <typename T>
-typename BinarySearchTree<T>::Node &BinarySearchTree<T>::RestrictedIterator::get_node() {
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::RestrictedIterator::get_node() {
     return *this->node;
 }
 
-template <typename T>
-BinarySearchTree<T>::RestrictedIterator::RestrictedIterator(Node &node) : Iterator(node) {}
+template <typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::RestrictedIterator::RestrictedIterator(Node &node) : Iterator(node) {}
+
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::restricted_iterator &BinarySearchTree<T, Allocator>::restricted_iterator::operator++() {
+    *this = restricted_iterator(this->find_next_node());
+    return *this;
+}
 
-template <typename T>
-void BinarySearchTree<T>::Node::set_value(const T &index) {
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::restricted_iterator BinarySearchTree<T, Allocator>::restricted_iterator::operator++(int) {
+    restricted_iterator temp = *this;
+    ++*this;
+    return temp;
+}
+
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::restricted_iterator &BinarySearchTree<T, Allocator>::restricted_iterator::operator--() {
+    *this = restricted_iterator(this->find_prev_node());
+    return *this;
+}
+
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::restricted_iterator BinarySearchTree<T, Allocator>::restricted_iterator::operator--(int) {
+    restricted_iterator temp = *this;
+    --*this;
+    return temp;
+}
+
+template <typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::Node::set_value(const T &index) {
     this->value = index;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::Node &BinarySearchTree<T>::Node::left() {
-    return this->p_bst->at(this->left_index);
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::Node::left() noexcept {
+    return this->relative(this->left_index);
 }
 
-template <typename T>
-typename BinarySearchTree<T>::Node &BinarySearchTree<T>::Node::right() {
-    return this->p_bst->at(this->right_index);
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::Node::right() noexcept {
+    return this->relative(this->right_index);
 }
 
-template <typename T>
-typename BinarySearchTree<T>::Node &BinarySearchTree<T>::Node::parent() {
-    return this->p_bst->at(this->parent_index);
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::Node::parent() noexcept {
+    return this->relative(this->parent_index);
 }
 
-template <typename T>
-typename BinarySearchTree<T>::Node &BinarySearchTree<T>::Node::sibling() {
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Node &BinarySearchTree<T, Allocator>::Node::sibling() noexcept {
     if(this->is_left_sibling()) return this->parent().right();
     else return this->parent().left();
 }
 
-template <typename T>
-bool BinarySearchTree<T>::iterator::operator<(const Iterator &other) const {
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::iterator::operator<(const Iterator &other) const {
     if(other.node->is_end_node() && !this->node->is_end_node()) return true;
     return *this->ptr < *other.ptr;
 }
 
-template <typename T>
-bool BinarySearchTree<T>::iterator::operator<=(const Iterator &other) const {
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::iterator::operator<=(const Iterator &other) const {
     if(this->node->is_end_node() && other.node->is_end_node()) return false;
     return *this->ptr <= *other.ptr;
 }
 
-template <typename T>
-bool BinarySearchTree<T>::iterator::operator>(const Iterator &other) const {
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::iterator::operator>(const Iterator &other) const {
     return *this->ptr > *other.ptr;
 }
 
-template <typename T>
-bool BinarySearchTree<T>::iterator::operator>=(const Iterator &other) const {
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::iterator::operator>=(const Iterator &other) const {
     if(this->node->is_end_node()) return false;
     return *this->ptr >= *other.ptr;
 }
 
-template <typename T>
-bool BinarySearchTree<T>::Node::is_end_node() const {
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::Node::is_end_node() const noexcept {
     return this->node_index == 0;
 }
 
-template <typename T>
-BinarySearchTree<T>::iterator BinarySearchTree<T>::successor_find(const T &value) {
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::Node::is_red() const noexcept {
+    return this->red;
+}
+
+template <typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::Node::set_red(bool red) noexcept {
+    this->red = red;
+}
+
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::Node::is_dead() const noexcept {
+    return this->dead;
+}
+
+template <typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::Node::set_dead(bool dead) noexcept {
+    this->dead = dead;
+}
+
+template <typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::iterator BinarySearchTree<T, Allocator>::successor_find(const T &value) {
+    iterator it = this->find_lower_bound(value);
+    if(it.node->is_dead()) ++it;
+    return it;
+}
+
+template <typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::iterator BinarySearchTree<T, Allocator>::predecessor_find(const T &value) {
     if(this->empty()) return this->end();
     Node *node = &this->root();
     Node *potential = &this->at(0);
     while(true) {
-        if(node->get_value() == value) break;
-        if(node->get_value() >= value && (potential->get_value() > node->get_value() || potential->is_end_node())) {
-            potential = node;
+        if(value < node->get_value()) {
+            if(!node->has_left()) break;
+            node = &node->left();
         }
-        if(value > node->get_value()) {
-            if(!node->has_right()) {
-                break;
-            }
+        else {
+            potential = node;
+            if(!this->multiset && !(node->get_value() < value)) break;
+            if(!node->has_right()) break;
             node = &node->right();
         }
-        else if(value < node->get_value()) {
-            if(!node->has_left()) {
-                break;
-            }
-            node = &node->left();
-        }
     }
-    if(node->get_value() >= value && (potential->get_value() > node->get_value() || potential->is_end_node())) {
-        potential = node;
-    }
-    return iterator(*potential);
+    iterator it(*potential);
+    if(potential->is_dead()) --it;
+    return it;
 }
 
-template <typename T>
-BinarySearchTree<T>::iterator BinarySearchTree<T>::predecessor_find(const T &value) {
-    if(this->empty()) return this->end();
-    Node *node = &this->root();
-    Node *potential = &this->at(0);
-    while(true) {
-        if(node->get_value() == value) break;
-        if(node->get_value() <= value && (potential->get_value() < node->get_value() || potential->is_end_node())) {
-            potential = node;
+template <typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::enable_multiset() {
+    this->multiset = true;
+}
+
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::is_multiset() const {
+    return this->multiset;
+}
+
+template <typename T, typename Allocator>
+std::pair<typename BinarySearchTree<T, Allocator>::iterator, typename BinarySearchTree<T, Allocator>::iterator>
+BinarySearchTree<T, Allocator>::equal_range(const T &value) {
+    iterator first = this->successor_find(value);
+    iterator last = first;
+    while(last != this->end() && !(value < *last)) ++last;
+    return {first, last};
+}
+
+template <typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::enable_filter(double false_positive_rate, size_t expected_size) requires Hashable<T> {
+    this->filtered = true;
+    this->filter.reset(std::max(expected_size, this->size()), false_positive_rate);
+    this->for_each([this](const T &value) { this->filter.insert(value); });
+}
+
+template <typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::disable_filter() {
+    this->filtered = false;
+    this->filter = CountingBloomFilter<T, Allocator>(this->get_allocator());
+}
+
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::has_filter() const {
+    return this->filtered;
+}
+
+template <typename T, typename Allocator>
+size_t BinarySearchTree<T, Allocator>::filter_memory() const {
+    return this->filtered ? this->filter.memory_usage() : 0;
+}
+
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::contains(const T &value) {
+    return this->find(value) != this->end();
+}
+
+template <typename T, typename Allocator>
+size_t BinarySearchTree<T, Allocator>::depth(const T &value) const {
+    if(this->empty()) return 0;
+    const Node *node = &this->root();
+    for(size_t depth = 1;; depth++) {
+        if(value < node->get_value()) {
+            if(!node->has_left()) return 0;
+            node = &node->left();
         }
-        if(value > node->get_value()) {
-            if(!node->has_right()) {
-                break;
-            }
+        else if(node->get_value() < value) {
+            if(!node->has_right()) return 0;
             node = &node->right();
         }
-        else if(value < node->get_value()) {
-            if(!node->has_left()) {
-                break;
-            }
-            node = &node->left();
+        else return node->is_dead() ? 0 : depth;
+    }
+}
+
+// Called before the value is stored, so a regrow never counts it twice.
+template <typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::filter_insert(const T &value) {
+    if constexpr(Hashable<T>) {
+        if(!this->filtered) return;
+        if(this->size() >= this->filter.get_capacity()) {
+            this->enable_filter(this->filter.get_false_positive_rate(), 2 * this->filter.get_capacity());
+        }
+        this->filter.insert(value);
+    }
+}
+
+template <typename T, typename Allocator>
+void BinarySearchTree<T, Allocator>::filter_remove(const T &value) {
+    if constexpr(Hashable<T>) {
+        if(this->filtered) this->filter.remove(value);
+    }
+}
+
+template <typename T, typename Allocator>
+bool BinarySearchTree<T, Allocator>::filter_excludes(const T &value) const {
+    if constexpr(Hashable<T>) return this->filtered && !this->filter.might_contain(value);
+    else return false;
+}
+
+template <typename T, typename Allocator>
+typename BinarySearchTree<T, Allocator>::Cursor BinarySearchTree<T, Allocator>::cursor() {
+    return Cursor(*this);
+}
+
+template <typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::Cursor::Cursor(BinarySearchTree &tree) : tree(&tree) {}
+
+// Indices move when nodes are removed; a finger past the end just restarts from the root.
+template <typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::restricted_iterator BinarySearchTree<T, Allocator>::Cursor::locate(const T &value) {
+    if(this->finger > this->tree->node_count()) this->finger = 0;
+    restricted_iterator it = this->tree->find_lower_bound(value, this->tree->at(this->finger));
+    if(!it.get_node().is_end_node()) this->finger = it.get_node().get_node_index();
+    return it;
+}
+
+template <typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::iterator BinarySearchTree<T, Allocator>::Cursor::seek(const T &value) {
+    iterator it = this->locate(value);
+    if(it.node->is_dead()) ++it;
+    return it;
+}
+
+template <typename T, typename Allocator>
+BinarySearchTree<T, Allocator>::iterator BinarySearchTree<T, Allocator>::Cursor::find(const T &value) {
+    if(this->tree->filter_excludes(value)) return this->tree->end();
+    iterator it = this->seek(value);
+    if(it == this->tree->end() || value < *it) return this->tree->end();
+    return it;
+}
+
+// The located node is the exact hint the engine's hinted insert wants; a multiset inserts after its equal keys.
+template <typename T, typename Allocator>
+std::pair<typename BinarySearchTree<T, Allocator>::iterator, bool>
+BinarySearchTree<T, Allocator>::Cursor::insert(const T &value) {
+    restricted_iterator hint = this->locate(value);
+    if(this->tree->multiset) {
+        while(!hint.get_node().is_end_node() && !(value < *hint)) ++hint;
+    }
+    size_t before = this->tree->size();
+    iterator it = this->tree->insert(iterator(hint.get_node()), value);
+    this->finger = it.node->get_node_index();
+    return {it, this->tree->size() != before};
+}
+
+template <typename T, typename Allocator>
+size_t BinarySearchTree<T, Allocator>::count(const T &value) {
+    auto [first, last] = this->equal_range(value);
+    size_t result = 0;
+    for(; first != last; ++first) result++;
+    return result;
+}
+
+// In-order walk of the subtree at index; stops early once visit returns false.
+template <typename T, typename Allocator>
+template <typename Visitor>
+bool BinarySearchTree<T, Allocator>::walk(size_t index, Visitor &visit) const {
+    vector<size_t> path(this->tree_container.get_allocator());
+    path.reserve(64);
+    while(index != 0 || !path.empty()) {
+        while(index != 0) {
+            const Node &node = this->tree_container[index];
+            bst_prefetch(&this->tree_container[node.get_right_index()]);
+            path.push_back(index);
+            index = node.get_left_index();
         }
+        const Node &node = this->tree_container[path.back()];
+        path.pop_back();
+        if(!node.is_dead() && !visit(node.value)) return false;
+        index = node.get_right_index();
+    }
+    return true;
+}
+
+template <typename T, typename Allocator>
+template <typename Function>
+void BinarySearchTree<T, Allocator>::for_each(Function fn) const {
+    auto visit = [&fn](const T &value) {
+        fn(value);
+        return true;
+    };
+    this->walk(this->at(0).get_left_index(), visit);
+}
+
+// The top levels are peeled off on the calling thread until there are a few subtrees per thread, then the
+// threads (the caller included) claim whole subtrees until none are left.
+template <typename T, typename Allocator>
+template <typename Function>
+void BinarySearchTree<T, Allocator>::parallel_for_each(Function fn, size_t threads) const {
+    if(threads <= 1 || this->node_count() < parallel_min_size) {
+        this->for_each(fn);
+        return;
     }
-    if(node->get_value() <= value && (potential->get_value() < node->get_value() || potential->is_end_node())) {
-        potential = node;
+
+    vector<size_t> subtrees(this->tree_container.get_allocator());
+    vector<size_t> next_level(this->tree_container.get_allocator());
+    subtrees.push_back(this->at(0).get_left_index());
+    while(!subtrees.empty() && subtrees.size() < 4 * threads) {
+        next_level.clear();
+        for(size_t index : subtrees) {
+            const Node &node = this->tree_container[index];
+            if(!node.is_dead()) fn(node.value);
+            if(node.has_left()) next_level.push_back(node.get_left_index());
+            if(node.has_right()) next_level.push_back(node.get_right_index());
+        }
+        std::swap(subtrees, next_level);
     }
-    return iterator(*potential);
+
+    parallel_run(subtrees.size(), threads, [this, &subtrees, &fn](size_t i) {
+        auto visit = [&fn](const T &value) {
+            fn(value);
+            return true;
+        };
+        this->walk(subtrees[i], visit);
+    });
+}
+
+template <typename T, typename Allocator>
+template <typename Function>
+void BinarySearchTree<T, Allocator>::parallel_run(size_t tasks, size_t threads, Function task) {
+    std::atomic<size_t> next_task = 0;
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto work = [&]() {
+        try {
+            for(size_t i = next_task++; i < tasks; i = next_task++) task(i);
+        }
+        catch(...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if(!error) error = std::current_exception();
+            next_task = tasks;
+        }
+    };
+    std::vector<std::thread> workers;
+    threads = std::min(threads, tasks);
+    if(threads > 1) workers.reserve(threads - 1);
+    for(size_t i = 1; i < threads; i++) workers.emplace_back(work);
+    work();
+    for(auto &worker : workers) worker.join();
+    if(error) std::rethrow_exception(error);
+}
+
+template <typename T, typename Allocator>
+size_t BinarySearchTree<T, Allocator>::copy_to(std::span<T> out) const {
+    size_t count = 0;
+    auto visit = [&out, &count](const T &value) {
+        if(count == out.size()) return false;
+        out[count++] = value;
+        return true;
+    };
+    this->walk(this->at(0).get_left_index(), visit);
+    return count;
+}
+
+template <typename T, typename Allocator>
+std::vector<T, Allocator> BinarySearchTree<T, Allocator>::to_vector() const {
+    std::vector<T, Allocator> result(this->get_allocator());
+    result.reserve(this->size());
+    this->for_each([&result](const T &value) { result.push_back(value); });
+    return result;
+}
+
+namespace pmr {
+    template <typename T>
+    using BinarySearchTree = ::BinarySearchTree<T, std::pmr::polymorphic_allocator<T>>;
 }
 
 #endif //BINARY_SEARCH_TREES_BST_H
@@ -0,0 +1,200 @@
+#ifndef BINARY_SEARCH_TREES_BUFFERED_H
+#define BINARY_SEARCH_TREES_BUFFERED_H
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// What BufferedTree calls on its engine: the updates it applies when flushing, contains() for the buffer's misses
+// and the read side it forwards. The BinarySearchTree engines all qualify.
+template <typename Tree>
+concept Bufferable = requires(Tree &tree, const typename Tree::iterator::DataType &value) {
+    tree.insert(value);
+    tree.remove(value);
+    { tree.contains(value) } -> std::convertible_to<bool>;
+    { tree.size() } -> std::convertible_to<size_t>;
+    tree.for_each([](const typename Tree::iterator::DataType &) {});
+    { tree.find(value) } -> std::same_as<typename Tree::iterator>;
+    { tree.predecessor_find(value) } -> std::same_as<typename Tree::iterator>;
+    { tree.successor_find(value) } -> std::same_as<typename Tree::iterator>;
+    { tree.begin() } -> std::same_as<typename Tree::iterator>;
+    { tree.end() } -> std::same_as<typename Tree::iterator>;
+};
+
+// Write buffer in front of any Bufferable tree engine, for ingest bursts. insert() and remove() only record a message:
+// new messages collect in a short tail that is sorted and merged into a sorted run every tail_limit messages, where a
+// later message for a key replaces the earlier one. flush() applies the run in key order, so each descent follows
+// the previous one down the same upper levels while they are still in cache; it runs by itself once `capacity`
+// messages wait. Applying a message twice changes nothing, so a flush cut short by an exception can simply be
+// repeated. contains() looks at the buffer before the tree and answers without flushing; everything that hands out
+// iterators or counts values flushes first.
+template <typename Tree>
+requires Bufferable<Tree>
+class BufferedTree {
+public:
+    using value_type = typename Tree::iterator::DataType;
+    using iterator = typename Tree::iterator;
+
+    template <typename... TreeArgs>
+    explicit BufferedTree(size_t capacity = 4096, TreeArgs &&...tree_args);
+    void insert(const value_type &value);
+    void remove(const value_type &value);
+    [[nodiscard]] bool contains(const value_type &value);
+    iterator find(const value_type &value);
+    iterator predecessor_find(const value_type &value);
+    iterator successor_find(const value_type &value);
+    [[nodiscard]] size_t size();
+    iterator begin();
+    iterator end();
+    template <typename Function>
+    void for_each(Function fn);
+    void flush();
+    [[nodiscard]] size_t buffered() const;     // messages waiting for the next flush
+
+private:
+    struct Message {
+        value_type value;
+        bool insert;
+    };
+
+    static constexpr size_t tail_limit = 64;
+
+    Tree tree;
+    size_t capacity;
+    std::vector<Message> buffer;    // [0, sorted) is sorted with one message per key, newer messages follow
+    size_t sorted = 0;
+
+private:
+    void put(const value_type &value, bool insert);
+    void merge_tail();
+};
+
+template <typename Tree>
+requires Bufferable<Tree>
+template <typename... TreeArgs>
+BufferedTree<Tree>::BufferedTree(size_t capacity, TreeArgs &&...tree_args)
+        : tree(std::forward<TreeArgs>(tree_args)...), capacity(std::max<size_t>(capacity, 1)) {
+    this->buffer.reserve(this->capacity);
+}
+
+template <typename Tree>
+requires Bufferable<Tree>
+void BufferedTree<Tree>::put(const value_type &value, bool insert) {
+    this->buffer.push_back({value, insert});
+    if(this->buffer.size() >= this->capacity) this->flush();
+    else if(this->buffer.size() - this->sorted >= tail_limit) this->merge_tail();
+}
+
+// Both sorts are stable, so among equal keys the newest message ends up last and is the one kept.
+template <typename Tree>
+requires Bufferable<Tree>
+void BufferedTree<Tree>::merge_tail() {
+    auto less = [](const Message &first, const Message &second) { return first.value < second.value; };
+    auto middle = this->buffer.begin() + static_cast<std::ptrdiff_t>(this->sorted);
+    std::stable_sort(middle, this->buffer.end(), less);
+    std::inplace_merge(this->buffer.begin(), middle, this->buffer.end(), less);
+    size_t kept = 0;
+    for(size_t i = 0; i < this->buffer.size(); i++) {
+        if(i + 1 < this->buffer.size() && !(this->buffer[i].value < this->buffer[i + 1].value)) continue;
+        this->buffer[kept++] = this->buffer[i];
+    }
+    this->buffer.resize(kept);
+    this->sorted = kept;
+}
+
+template <typename Tree>
+requires Bufferable<Tree>
+void BufferedTree<Tree>::insert(const value_type &value) {
+    this->put(value, true);
+}
+
+template <typename Tree>
+requires Bufferable<Tree>
+void BufferedTree<Tree>::remove(const value_type &value) {
+    this->put(value, false);
+}
+
+template <typename Tree>
+requires Bufferable<Tree>
+bool BufferedTree<Tree>::contains(const value_type &value) {
+    for(size_t i = this->buffer.size(); i-- > this->sorted;) {
+        if(!(this->buffer[i].value < value) && !(value < this->buffer[i].value)) return this->buffer[i].insert;
+    }
+    auto end = this->buffer.begin() + static_cast<std::ptrdiff_t>(this->sorted);
+    auto it = std::lower_bound(this->buffer.begin(), end, value,
+                               [](const Message &message, const value_type &key) { return message.value < key; });
+    if(it != end && !(value < it->value)) return it->insert;
+    return this->tree.contains(value);
+}
+
+template <typename Tree>
+requires Bufferable<Tree>
+void BufferedTree<Tree>::flush() {
+    if(this->buffer.empty()) return;
+    this->merge_tail();
+    for(const Message &message : this->buffer) {
+        if(message.insert) this->tree.insert(message.value);
+        else this->tree.remove(message.value);
+    }
+    this->buffer.clear();
+    this->sorted = 0;
+}
+
+template <typename Tree>
+requires Bufferable<Tree>
+size_t BufferedTree<Tree>::buffered() const {
+    return this->buffer.size();
+}
+
+template <typename Tree>
+requires Bufferable<Tree>
+typename BufferedTree<Tree>::iterator BufferedTree<Tree>::find(const value_type &value) {
+    this->flush();
+    return this->tree.find(value);
+}
+
+template <typename Tree>
+requires Bufferable<Tree>
+typename BufferedTree<Tree>::iterator BufferedTree<Tree>::predecessor_find(const value_type &value) {
+    this->flush();
+    return this->tree.predecessor_find(value);
+}
+
+template <typename Tree>
+requires Bufferable<Tree>
+typename BufferedTree<Tree>::iterator BufferedTree<Tree>::successor_find(const value_type &value) {
+    this->flush();
+    return this->tree.successor_find(value);
+}
+
+template <typename Tree>
+requires Bufferable<Tree>
+size_t BufferedTree<Tree>::size() {
+    this->flush();
+    return this->tree.size();
+}
+
+template <typename Tree>
+requires Bufferable<Tree>
+typename BufferedTree<Tree>::iterator BufferedTree<Tree>::begin() {
+    this->flush();
+    return this->tree.begin();
+}
+
+template <typename Tree>
+requires Bufferable<Tree>
+typename BufferedTree<Tree>::iterator BufferedTree<Tree>::end() {
+    return this->tree.end();
+}
+
+template <typename Tree>
+requires Bufferable<Tree>
+template <typename Function>
+void BufferedTree<Tree>::for_each(Function fn) {
+    this->flush();
+    this->tree.for_each(fn);
+}
+
+#endif //BINARY_SEARCH_TREES_BUFFERED_H
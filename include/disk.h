@@ -0,0 +1,672 @@
+#ifndef BINARY_SEARCH_TREES_DISK_H
+#define BINARY_SEARCH_TREES_DISK_H
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+struct DiskTreeOptions {
+    size_t page_size = 4096;
+    size_t memory_budget = 64 << 20;    // bytes of page frames the buffer pool may hold, at least 16 frames
+    double alpha = .7;                  // scapegoat balance, between .5 and .95
+};
+
+struct DiskTreeStats {
+    size_t page_fetches = 0;    // page accesses through the buffer pool
+    size_t page_misses = 0;     // fetches that had to read the page from the file
+    size_t page_writes = 0;     // dirty pages written back
+};
+
+// Out-of-core scapegoat tree for sets larger than memory. Nodes live in fixed-size pages of a scratch file, which
+// the tree creates, truncates and removes again; only a CLOCK buffer pool of memory_budget bytes and two counters
+// per page stay resident. A new node goes into its parent's page while that has room, and a rebuild lays its
+// subtree out page by page: every page holds the top levels of a subtree, so one fetch serves about
+// log2(nodes per page) levels of a search. Rebuilds stream the old nodes in order and keep O(log n) of them in
+// memory. remove() marks nodes dead; the whole tree is rebuilt once half of its nodes are dead or half of the
+// handed out page slots no longer hold a node.
+template <typename T>
+class DiskTree {
+    static_assert(std::is_trivially_copyable_v<T>, "DiskTree stores values as raw bytes");
+public:
+    class Iterator;
+    using iterator = Iterator;
+    using value_type = T;
+    explicit DiskTree(std::filesystem::path path, DiskTreeOptions options = DiskTreeOptions());
+    DiskTree(const DiskTree &) = delete;
+    DiskTree &operator=(const DiskTree &) = delete;
+    ~DiskTree();
+    std::pair<iterator, bool> insert(const T &value);
+    void remove(const T &value);
+    iterator find(const T &value);
+    iterator predecessor_find(const T &value);
+    iterator successor_find(const T &value);
+    [[nodiscard]] size_t size() const;
+    iterator begin();
+    iterator end();
+    void compact();     // rebuilds the whole tree into the page-blocked layout
+    void flush();       // writes every dirty page back
+    [[nodiscard]] const DiskTreeStats &stats() const;
+    void reset_stats();
+    [[nodiscard]] size_t slot_count() const;    // page slots handed out and not yet reclaimed, live or dead
+public:
+    // Keeps a copy of its value, so it stays readable while the pool evicts the page it came from.
+    class Iterator {
+    public:
+        using DataType = T;
+        using PointerType = const DataType*;
+        using RefType = const DataType&;
+
+        Iterator &operator++();
+        Iterator operator++(int);
+        Iterator &operator--();
+        Iterator operator--(int);
+        RefType operator*() const;
+        bool operator==(const Iterator &other) const;
+        bool operator!=(const Iterator &other) const;
+
+        Iterator(DiskTree *p_tree, uint64_t node_id);
+    private:
+        friend class DiskTree;
+
+        DiskTree *p_tree;
+        uint64_t node_id;
+        T value{};
+    };
+private:
+    // Node ids are page * nodes_per_page + slot + 1, so 0 is the null link.
+    struct Node {
+        uint64_t left;
+        uint64_t right;
+        uint64_t parent;
+        T value;
+        bool dead;
+    };
+    struct Frame {
+        uint64_t page;
+        bool referenced;
+        bool dirty;
+    };
+    // In-order walk over the nodes of the subtree being rebuilt, handing out the live values.
+    struct Stream {
+        uint64_t node_id;
+        size_t remaining;
+        std::vector<uint64_t> emptied_pages;    // released only once the walk cannot climb into them again
+        uint64_t tracked;                       // old id of a node to follow, replaced by its new id once built
+    };
+    static constexpr uint64_t no_page = UINT64_MAX;
+
+    std::filesystem::path path;
+    int fd = -1;
+    size_t page_size;
+    size_t nodes_per_page;
+    size_t block_height;        // levels of a rebuilt subtree that share one page
+    double alpha;
+    std::vector<char> frame_data;
+    std::vector<Frame> frames;
+    std::unordered_map<uint64_t, size_t> frame_of;
+    size_t clock_hand = 0;
+    std::vector<uint32_t> page_used;    // slots handed out, by page
+    std::vector<uint32_t> page_live;    // slots still holding a node of the tree, by page
+    std::vector<uint64_t> free_pages;
+    uint64_t fill_page = no_page;       // takes new nodes whose parent's page is full
+    size_t used_slots = 0;
+    uint64_t root_id = 0;
+    size_t node_count = 0;              // dead nodes included
+    size_t dead_count = 0;
+    size_t height_limit = 0;
+    size_t height_limit_min_size = 0;
+    size_t height_limit_max_size = 0;
+    DiskTreeStats statistics;
+private:
+    static void throw_errno(const std::string &what);
+    char *page_data(uint64_t page, bool write, bool fresh = false);
+    size_t take_frame();
+    void write_back(size_t frame);
+    [[nodiscard]] Node load(uint64_t id);
+    void store(uint64_t id, const Node &node);
+    [[nodiscard]] uint64_t page_of(uint64_t id) const;
+    uint64_t allocate_page();
+    uint64_t allocate_slot(uint64_t page);
+    void release_page(uint64_t page);
+    uint64_t leftmost(uint64_t id);
+    uint64_t rightmost(uint64_t id);
+    uint64_t next_id(uint64_t id);
+    uint64_t prev_id(uint64_t id);
+    iterator make_iterator(uint64_t id, bool forward);
+    std::pair<size_t, size_t> count(uint64_t id);      // nodes and live nodes of a subtree
+    [[nodiscard]] bool is_height_balanced(size_t depth);
+    void update_height_limit();
+    // Both return the new id of the node `tracked` named, or `tracked` itself if it was not rebuilt.
+    uint64_t rebuild(uint64_t id, size_t total, size_t live, uint64_t tracked = 0);
+    uint64_t rebuild_tree(uint64_t tracked = 0);
+    uint64_t build(Stream &stream, size_t low, size_t high, uint64_t parent, uint64_t page, size_t depth);
+    T next_live(Stream &stream, uint64_t new_id);
+    void skip(Stream &stream);
+};
+
+template <typename T>
+DiskTree<T>::DiskTree(std::filesystem::path path, DiskTreeOptions options) : path(std::move(path)) {
+    this->page_size = std::max(options.page_size, 4 * sizeof(Node));
+    this->nodes_per_page = this->page_size / sizeof(Node);
+    this->block_height = static_cast<size_t>(std::floor(std::log2(static_cast<double>(this->nodes_per_page + 1))));
+    this->alpha = std::clamp(options.alpha, .5, .95);
+    size_t frame_count = std::max<size_t>(16, options.memory_budget / this->page_size);
+    this->frame_data.resize(frame_count * this->page_size);
+    this->frames.assign(frame_count, Frame{no_page, false, false});
+    this->fd = ::open(this->path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(this->fd < 0) throw_errno("open " + this->path.string());
+}
+
+template <typename T>
+DiskTree<T>::~DiskTree() {
+    if(this->fd >= 0) ::close(this->fd);
+    std::error_code error;
+    std::filesystem::remove(this->path, error);
+}
+
+template <typename T>
+void DiskTree<T>::throw_errno(const std::string &what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+// A fresh page has no content worth reading yet, so it is installed zeroed instead of fetched.
+template <typename T>
+char *DiskTree<T>::page_data(uint64_t page, bool write, bool fresh) {
+    this->statistics.page_fetches++;
+    size_t frame;
+    auto it = this->frame_of.find(page);
+    if(it != this->frame_of.end()) frame = it->second;
+    else {
+        frame = this->take_frame();
+        char *data = &this->frame_data[frame * this->page_size];
+        if(fresh) std::memset(data, 0, this->page_size);
+        else {
+            this->statistics.page_misses++;
+            size_t done = 0;
+            while(done < this->page_size) {
+                ssize_t read = ::pread(this->fd, data + done, this->page_size - done,
+                                       static_cast<off_t>(page * this->page_size + done));
+                if(read < 0) {
+                    if(errno == EINTR) continue;
+                    throw_errno("pread " + this->path.string());
+                }
+                if(read == 0) {
+                    std::memset(data + done, 0, this->page_size - done);
+                    break;
+                }
+                done += static_cast<size_t>(read);
+            }
+        }
+        this->frames[frame].page = page;
+        this->frame_of.emplace(page, frame);
+    }
+    this->frames[frame].referenced = true;
+    if(write || fresh) this->frames[frame].dirty = true;
+    return &this->frame_data[frame * this->page_size];
+}
+
+// CLOCK: a referenced frame gets a second chance, the first one that was not touched since the last sweep goes.
+template <typename T>
+size_t DiskTree<T>::take_frame() {
+    while(true) {
+        size_t frame = this->clock_hand;
+        this->clock_hand = (this->clock_hand + 1) % this->frames.size();
+        Frame &current = this->frames[frame];
+        if(current.page == no_page) return frame;
+        if(current.referenced) {
+            current.referenced = false;
+            continue;
+        }
+        if(current.dirty) this->write_back(frame);
+        this->frame_of.erase(current.page);
+        current.page = no_page;
+        return frame;
+    }
+}
+
+template <typename T>
+void DiskTree<T>::write_back(size_t frame) {
+    const char *data = &this->frame_data[frame * this->page_size];
+    uint64_t page = this->frames[frame].page;
+    size_t done = 0;
+    while(done < this->page_size) {
+        ssize_t written = ::pwrite(this->fd, data + done, this->page_size - done,
+                                   static_cast<off_t>(page * this->page_size + done));
+        if(written < 0) {
+            if(errno == EINTR) continue;
+            throw_errno("pwrite " + this->path.string());
+        }
+        done += static_cast<size_t>(written);
+    }
+    this->frames[frame].dirty = false;
+    this->statistics.page_writes++;
+}
+
+template <typename T>
+typename DiskTree<T>::Node DiskTree<T>::load(uint64_t id) {
+    Node node;
+    uint64_t slot = (id - 1) % this->nodes_per_page;
+    std::memcpy(&node, this->page_data(this->page_of(id), false) + slot * sizeof(Node), sizeof(Node));
+    return node;
+}
+
+template <typename T>
+void DiskTree<T>::store(uint64_t id, const Node &node) {
+    uint64_t slot = (id - 1) % this->nodes_per_page;
+    std::memcpy(this->page_data(this->page_of(id), true) + slot * sizeof(Node), &node, sizeof(Node));
+}
+
+template <typename T>
+uint64_t DiskTree<T>::page_of(uint64_t id) const {
+    return (id - 1) / this->nodes_per_page;
+}
+
+template <typename T>
+uint64_t DiskTree<T>::allocate_page() {
+    if(!this->free_pages.empty()) {
+        uint64_t page = this->free_pages.back();
+        this->free_pages.pop_back();
+        return page;
+    }
+    this->page_used.push_back(0);
+    this->page_live.push_back(0);
+    return this->page_used.size() - 1;
+}
+
+// Next slot of page, or of the fill page when page is no_page or full.
+template <typename T>
+uint64_t DiskTree<T>::allocate_slot(uint64_t page) {
+    if(page == no_page || this->page_used[page] == this->nodes_per_page) {
+        if(this->fill_page == no_page || this->page_used[this->fill_page] == this->nodes_per_page) {
+            this->fill_page = this->allocate_page();
+        }
+        page = this->fill_page;
+    }
+    if(this->page_used[page] == 0) this->page_data(page, true, true);
+    uint64_t slot = this->page_used[page]++;
+    this->page_live[page]++;
+    this->used_slots++;
+    return page * this->nodes_per_page + slot + 1;
+}
+
+template <typename T>
+void DiskTree<T>::release_page(uint64_t page) {
+    this->used_slots -= this->page_used[page];
+    this->page_used[page] = this->page_live[page] = 0;
+    if(this->fill_page == page) this->fill_page = no_page;
+    auto it = this->frame_of.find(page);
+    if(it != this->frame_of.end()) {
+        this->frames[it->second] = Frame{no_page, false, false};
+        this->frame_of.erase(it);
+    }
+    this->free_pages.push_back(page);
+}
+
+template <typename T>
+uint64_t DiskTree<T>::leftmost(uint64_t id) {
+    if(id == 0) return 0;
+    for(uint64_t left = this->load(id).left; left != 0; left = this->load(id).left) id = left;
+    return id;
+}
+
+template <typename T>
+uint64_t DiskTree<T>::rightmost(uint64_t id) {
+    if(id == 0) return 0;
+    for(uint64_t right = this->load(id).right; right != 0; right = this->load(id).right) id = right;
+    return id;
+}
+
+template <typename T>
+uint64_t DiskTree<T>::next_id(uint64_t id) {
+    Node node = this->load(id);
+    if(node.right != 0) return this->leftmost(node.right);
+    uint64_t parent = node.parent;
+    while(parent != 0) {
+        Node above = this->load(parent);
+        if(above.left == id) return parent;
+        id = parent;
+        parent = above.parent;
+    }
+    return 0;
+}
+
+template <typename T>
+uint64_t DiskTree<T>::prev_id(uint64_t id) {
+    Node node = this->load(id);
+    if(node.left != 0) return this->rightmost(node.left);
+    uint64_t parent = node.parent;
+    while(parent != 0) {
+        Node above = this->load(parent);
+        if(above.right == id) return parent;
+        id = parent;
+        parent = above.parent;
+    }
+    return 0;
+}
+
+template <typename T>
+typename DiskTree<T>::iterator DiskTree<T>::make_iterator(uint64_t id, bool forward) {
+    while(id != 0 && this->load(id).dead) id = forward ? this->next_id(id) : this->prev_id(id);
+    return iterator(this, id);
+}
+
+template <typename T>
+std::pair<size_t, size_t> DiskTree<T>::count(uint64_t id) {
+    size_t total = 0, live = 0;
+    std::vector<uint64_t> pending;
+    if(id != 0) pending.push_back(id);
+    while(!pending.empty()) {
+        Node node = this->load(pending.back());
+        pending.pop_back();
+        total++;
+        live += !node.dead;
+        if(node.left != 0) pending.push_back(node.left);
+        if(node.right != 0) pending.push_back(node.right);
+    }
+    return {total, live};
+}
+
+// The limit only changes when node_count crosses a power of 1/alpha, as in ScapegoatTree.
+template <typename T>
+bool DiskTree<T>::is_height_balanced(size_t depth) {
+    if(this->node_count < this->height_limit_min_size || this->node_count >= this->height_limit_max_size) {
+        this->update_height_limit();
+    }
+    return depth <= this->height_limit;
+}
+
+template <typename T>
+void DiskTree<T>::update_height_limit() {
+    double base = 1 / this->alpha;
+    double size = static_cast<double>(this->node_count);
+    this->height_limit = static_cast<size_t>(std::floor(std::log(size) / std::log(base)));
+    this->height_limit_min_size = static_cast<size_t>(std::ceil(std::pow(base, this->height_limit)));
+    this->height_limit_max_size = static_cast<size_t>(std::ceil(std::pow(base, this->height_limit + 1)));
+}
+
+template <typename T>
+std::pair<typename DiskTree<T>::iterator, bool> DiskTree<T>::insert(const T &value) {
+    if(this->root_id == 0) {
+        this->root_id = this->allocate_slot(no_page);
+        this->store(this->root_id, Node{0, 0, 0, value, false});
+        this->node_count = 1;
+        return {iterator(this, this->root_id), true};
+    }
+
+    uint64_t id = this->root_id;
+    size_t depth = 1;
+    Node node;
+    while(true) {
+        node = this->load(id);
+        uint64_t next;
+        if(value < node.value) next = node.left;
+        else if(node.value < value) next = node.right;
+        else {
+            if(!node.dead) return {iterator(this, id), false};
+            node.dead = false;
+            this->store(id, node);
+            this->dead_count--;
+            return {iterator(this, id), true};
+        }
+        if(next == 0) break;
+        id = next;
+        depth++;
+    }
+
+    uint64_t new_id = this->allocate_slot(this->page_of(id));
+    this->store(new_id, Node{0, 0, id, value, false});
+    node = this->load(id);
+    if(value < node.value) node.left = new_id;
+    else node.right = new_id;
+    this->store(id, node);
+    this->node_count++;
+    if(this->is_height_balanced(depth)) return {iterator(this, new_id), true};
+
+    uint64_t child = new_id;
+    size_t child_total = 1, child_live = 1;
+    for(uint64_t parent = id; parent != 0;) {
+        Node above = this->load(parent);
+        auto [sibling_total, sibling_live] = this->count(above.left == child ? above.right : above.left);
+        size_t total = child_total + 1 + sibling_total, live = child_live + !above.dead + sibling_live;
+        if(child_total > this->alpha * total) {
+            new_id = this->rebuild(parent, total, live, new_id);
+            if(this->used_slots > 2 * (this->node_count + this->nodes_per_page)) new_id = this->rebuild_tree(new_id);
+            break;
+        }
+        child = parent;
+        child_total = total;
+        child_live = live;
+        parent = above.parent;
+    }
+    return {iterator(this, new_id), true};
+}
+
+template <typename T>
+void DiskTree<T>::remove(const T &value) {
+    iterator it = this->find(value);
+    if(it == this->end()) return;
+    Node node = this->load(it.node_id);
+    node.dead = true;
+    this->store(it.node_id, node);
+    this->dead_count++;
+    if(2 * this->dead_count > this->node_count) this->rebuild_tree();
+}
+
+template <typename T>
+typename DiskTree<T>::iterator DiskTree<T>::find(const T &value) {
+    for(uint64_t id = this->root_id; id != 0;) {
+        Node node = this->load(id);
+        if(value < node.value) id = node.left;
+        else if(node.value < value) id = node.right;
+        else return node.dead ? this->end() : iterator(this, id);
+    }
+    return this->end();
+}
+
+template <typename T>
+typename DiskTree<T>::iterator DiskTree<T>::successor_find(const T &value) {
+    uint64_t potential = 0;
+    for(uint64_t id = this->root_id; id != 0;) {
+        Node node = this->load(id);
+        if(node.value < value) id = node.right;
+        else {
+            potential = id;
+            if(!(value < node.value)) break;
+            id = node.left;
+        }
+    }
+    return this->make_iterator(potential, true);
+}
+
+template <typename T>
+typename DiskTree<T>::iterator DiskTree<T>::predecessor_find(const T &value) {
+    uint64_t potential = 0;
+    for(uint64_t id = this->root_id; id != 0;) {
+        Node node = this->load(id);
+        if(value < node.value) id = node.left;
+        else {
+            potential = id;
+            if(!(node.value < value)) break;
+            id = node.right;
+        }
+    }
+    return this->make_iterator(potential, false);
+}
+
+template <typename T>
+size_t DiskTree<T>::size() const {
+    return this->node_count - this->dead_count;
+}
+
+template <typename T>
+size_t DiskTree<T>::slot_count() const {
+    return this->used_slots;
+}
+
+template <typename T>
+typename DiskTree<T>::iterator DiskTree<T>::begin() {
+    return this->make_iterator(this->leftmost(this->root_id), true);
+}
+
+template <typename T>
+typename DiskTree<T>::iterator DiskTree<T>::end() {
+    return iterator(this, 0);
+}
+
+template <typename T>
+void DiskTree<T>::compact() {
+    this->rebuild_tree();
+}
+
+template <typename T>
+void DiskTree<T>::flush() {
+    for(size_t frame = 0; frame < this->frames.size(); frame++) {
+        if(this->frames[frame].page != no_page && this->frames[frame].dirty) this->write_back(frame);
+    }
+}
+
+template <typename T>
+const DiskTreeStats &DiskTree<T>::stats() const {
+    return this->statistics;
+}
+
+template <typename T>
+void DiskTree<T>::reset_stats() {
+    this->statistics = DiskTreeStats();
+}
+
+template <typename T>
+uint64_t DiskTree<T>::rebuild_tree(uint64_t tracked) {
+    if(this->root_id == 0) return tracked;
+    return this->rebuild(this->root_id, this->node_count, this->node_count - this->dead_count, tracked);
+}
+
+// The old nodes are read in order while the new subtree is written to fresh pages, so the two never share a page.
+template <typename T>
+uint64_t DiskTree<T>::rebuild(uint64_t id, size_t total, size_t live, uint64_t tracked) {
+    uint64_t parent = this->load(id).parent;
+    bool is_left = parent != 0 && this->load(parent).left == id;
+    Stream stream{this->leftmost(id), total, {}, tracked};
+    // Blocks are counted from the leaves up, so the partial block is the one at the top rather than a bottom row of
+    // half-empty pages.
+    size_t levels = std::bit_width(live);
+    size_t offset = (this->block_height - levels % this->block_height) % this->block_height;
+    uint64_t new_root = this->build(stream, 0, live, parent, no_page, offset);
+    while(stream.remaining > 0) this->skip(stream);     // dead nodes after the last live one
+    if(parent == 0) this->root_id = new_root;
+    else {
+        Node above = this->load(parent);
+        if(is_left) above.left = new_root;
+        else above.right = new_root;
+        this->store(parent, above);
+    }
+    for(uint64_t page : stream.emptied_pages) this->release_page(page);
+    this->node_count -= total - live;
+    this->dead_count -= total - live;
+    return stream.tracked;
+}
+
+// Ranks [low, high) become a balanced subtree under parent. Every block_height consecutive levels of a block share
+// one page; the ranges hanging below a block start blocks of their own.
+template <typename T>
+uint64_t DiskTree<T>::build(Stream &stream, size_t low, size_t high, uint64_t parent, uint64_t page, size_t depth) {
+    if(low == high) return 0;
+    if(page == no_page || depth % this->block_height == 0) page = this->allocate_page();
+    uint64_t id = this->allocate_slot(page);
+    size_t mid = low + (high - low) / 2;
+    Node node{0, 0, parent, T(), false};
+    node.left = this->build(stream, low, mid, id, page, depth + 1);
+    node.value = this->next_live(stream, id);
+    node.right = this->build(stream, mid + 1, high, id, page, depth + 1);
+    this->store(id, node);
+    return id;
+}
+
+template <typename T>
+T DiskTree<T>::next_live(Stream &stream, uint64_t new_id) {
+    while(true) {
+        uint64_t id = stream.node_id;
+        Node node = this->load(id);
+        this->skip(stream);
+        if(node.dead) continue;
+        if(id == stream.tracked) stream.tracked = new_id;
+        return node.value;
+    }
+}
+
+// Moves the stream past its current node, whose slot stops counting as live.
+template <typename T>
+void DiskTree<T>::skip(Stream &stream) {
+    uint64_t id = stream.node_id;
+    if(--stream.remaining > 0) stream.node_id = this->next_id(id);
+    uint64_t page = this->page_of(id);
+    if(--this->page_live[page] == 0) stream.emptied_pages.push_back(page);
+}
+
+template <typename T>
+DiskTree<T>::Iterator::Iterator(DiskTree *p_tree, uint64_t node_id) : p_tree(p_tree), node_id(node_id) {
+    if(node_id != 0) this->value = p_tree->load(node_id).value;
+}
+
+template <typename T>
+typename DiskTree<T>::iterator &DiskTree<T>::iterator::operator++() {
+    *this = this->p_tree->make_iterator(this->p_tree->next_id(this->node_id), true);
+    return *this;
+}
+
+template <typename T>
+typename DiskTree<T>::iterator DiskTree<T>::iterator::operator++(int) {
+    iterator temp = *this;
+    ++*this;
+    return temp;
+}
+
+template <typename T>
+typename DiskTree<T>::iterator &DiskTree<T>::iterator::operator--() {
+    uint64_t id = this->node_id == 0 ? this->p_tree->rightmost(this->p_tree->root_id) : this->p_tree->prev_id(this->node_id);
+    *this = this->p_tree->make_iterator(id, false);
+    return *this;
+}
+
+template <typename T>
+typename DiskTree<T>::iterator DiskTree<T>::iterator::operator--(int) {
+    iterator temp = *this;
+    --*this;
+    return temp;
+}
+
+template <typename T>
+typename DiskTree<T>::iterator::RefType DiskTree<T>::iterator::operator*() const {
+    return this->value;
+}
+
+template <typename T>
+bool DiskTree<T>::iterator::operator==(const iterator &other) const {
+    return this->node_id == other.node_id;
+}
+
+template <typename T>
+bool DiskTree<T>::iterator::operator!=(const iterator &other) const {
+    return this->node_id != other.node_id;
+}
+
+template class DiskTree<int>;
+template class DiskTree<float>;
+template class DiskTree<double>;
+template class DiskTree<unsigned int>;
+template class DiskTree<unsigned long long>;
+template class DiskTree<long long>;
+
+#endif //BINARY_SEARCH_TREES_DISK_H
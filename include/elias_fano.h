@@ -0,0 +1,334 @@
+#ifndef BINARY_SEARCH_TREES_ELIAS_FANO_H
+#define BINARY_SEARCH_TREES_ELIAS_FANO_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+template <typename Tree, typename T>
+concept InOrderTraversable = requires(const Tree &tree, void (*visit)(const T &)) { tree.for_each(visit); };
+
+// Immutable sorted set of unsigned integers in Elias-Fano form: each key is split into `low_width` low bits, stored
+// packed, and high bits, stored in unary as a bitmap where key i sets bit (high + i). That comes to about
+// 2 + log2(max / n) bits per key. Every select_sample-th one and zero of the bitmap is sampled, so access by rank
+// and lower_bound only scan a few words.
+template <typename T>
+class EliasFanoSet {
+    static_assert(std::is_unsigned_v<T>, "EliasFanoSet stores unsigned integer keys");
+public:
+    class Iterator;
+    using iterator = Iterator;
+
+    EliasFanoSet() = default;
+    explicit EliasFanoSet(const std::vector<T> &sorted_values);
+    // Any tree with an in-order for_each, so the keys are never copied out first.
+    template <InOrderTraversable<T> Tree>
+    explicit EliasFanoSet(const Tree &tree);
+    [[nodiscard]] iterator find(T value) const;
+    [[nodiscard]] iterator lower_bound(T value) const;
+    [[nodiscard]] iterator successor_find(T value) const;
+    [[nodiscard]] iterator predecessor_find(T value) const;
+    [[nodiscard]] bool contains(T value) const;
+    [[nodiscard]] size_t rank(T value) const;       // keys strictly less than value
+    [[nodiscard]] T select(size_t index) const;     // key with the given rank
+    [[nodiscard]] size_t size() const;
+    [[nodiscard]] size_t size_in_bytes() const;
+    [[nodiscard]] iterator begin() const;
+    [[nodiscard]] iterator end() const;
+
+public:
+    class Iterator {
+    public:
+        using DataType = T;
+
+        Iterator &operator++();
+        Iterator operator++(int);
+        Iterator &operator--();
+        Iterator operator--(int);
+        DataType operator*() const;
+        bool operator==(const Iterator &other) const;
+        bool operator!=(const Iterator &other) const;
+        [[nodiscard]] size_t get_rank() const;
+
+        Iterator(const EliasFanoSet *set, size_t index, size_t position);
+    private:
+        const EliasFanoSet *set;
+        size_t index;       // rank of the key
+        size_t position;    // its one in the high bitmap
+    };
+
+private:
+    static constexpr size_t select_sample = 512;
+    size_t count = 0;
+    unsigned low_width = 0;
+    uint64_t max_high = 0;              // high bits of the largest key
+    std::vector<uint64_t> low_bits;
+    std::vector<uint64_t> high_bits;
+    std::vector<size_t> one_samples;    // position of one number k * select_sample
+    std::vector<size_t> zero_samples;   // position of zero number k * select_sample
+
+private:
+    void reserve(size_t key_count, T max_value);
+    void push_back(T value);
+    void build_samples();
+    [[nodiscard]] T low(size_t index) const;
+    [[nodiscard]] size_t select_one(size_t k) const;
+    [[nodiscard]] size_t select_zero(size_t k) const;
+    [[nodiscard]] size_t next_one(size_t position) const;
+    [[nodiscard]] size_t prev_one(size_t position) const;
+    static unsigned select_in_word(uint64_t word, size_t k);
+};
+
+template <typename T>
+EliasFanoSet<T>::EliasFanoSet(const std::vector<T> &sorted_values) {
+    this->reserve(sorted_values.size(), sorted_values.empty() ? 0 : sorted_values.back());
+    for(T value : sorted_values) this->push_back(value);
+    this->build_samples();
+}
+
+template <typename T>
+template <InOrderTraversable<T> Tree>
+EliasFanoSet<T>::EliasFanoSet(const Tree &tree) {
+    size_t key_count = 0;
+    T max_value = 0;
+    tree.for_each([&key_count, &max_value](const T &value) {
+        key_count++;
+        max_value = value;
+    });
+    this->reserve(key_count, max_value);
+    tree.for_each([this](const T &value) { this->push_back(value); });
+    this->build_samples();
+}
+
+template <typename T>
+void EliasFanoSet<T>::reserve(size_t key_count, T max_value) {
+    uint64_t max = max_value;
+    this->low_width = key_count > 0 && max >= key_count ? std::bit_width(max / key_count) - 1 : 0;
+    this->max_high = max >> this->low_width;
+    this->low_bits.assign((key_count * this->low_width + 63) / 64 + 1, 0);
+    this->high_bits.assign((key_count + (max >> this->low_width) + 1) / 64 + 1, 0);
+}
+
+template <typename T>
+void EliasFanoSet<T>::push_back(T value) {
+    uint64_t key = value;
+    if(this->low_width > 0) {
+        uint64_t low = key & ((uint64_t(1) << this->low_width) - 1);
+        size_t bit = this->count * this->low_width;
+        this->low_bits[bit / 64] |= low << (bit % 64);
+        if(bit % 64 + this->low_width > 64) this->low_bits[bit / 64 + 1] |= low >> (64 - bit % 64);
+    }
+    size_t position = (key >> this->low_width) + this->count;
+    this->high_bits[position / 64] |= uint64_t(1) << (position % 64);
+    this->count++;
+}
+
+template <typename T>
+void EliasFanoSet<T>::build_samples() {
+    size_t ones = 0;
+    size_t zeros = 0;
+    for(size_t word = 0; word < this->high_bits.size(); word++) {
+        uint64_t bits = this->high_bits[word];
+        size_t word_ones = std::popcount(bits);
+        size_t next_one_sample = (ones + select_sample - 1) / select_sample * select_sample;
+        if(next_one_sample < ones + word_ones) {
+            this->one_samples.push_back(word * 64 + select_in_word(bits, next_one_sample - ones));
+        }
+        size_t next_zero_sample = (zeros + select_sample - 1) / select_sample * select_sample;
+        if(next_zero_sample < zeros + 64 - word_ones) {
+            this->zero_samples.push_back(word * 64 + select_in_word(~bits, next_zero_sample - zeros));
+        }
+        ones += word_ones;
+        zeros += 64 - word_ones;
+    }
+}
+
+template <typename T>
+unsigned EliasFanoSet<T>::select_in_word(uint64_t word, size_t k) {
+    for(size_t i = 0; i < k; i++) word &= word - 1;
+    return std::countr_zero(word);
+}
+
+template <typename T>
+T EliasFanoSet<T>::low(size_t index) const {
+    if(this->low_width == 0) return 0;
+    size_t bit = index * this->low_width;
+    uint64_t value = this->low_bits[bit / 64] >> (bit % 64);
+    if(bit % 64 + this->low_width > 64) value |= this->low_bits[bit / 64 + 1] << (64 - bit % 64);
+    return static_cast<T>(value & ((uint64_t(1) << this->low_width) - 1));
+}
+
+template <typename T>
+size_t EliasFanoSet<T>::select_one(size_t k) const {
+    size_t position = this->one_samples[k / select_sample];
+    size_t word = position / 64;
+    uint64_t bits = this->high_bits[word] & (~uint64_t(0) << (position % 64));
+    size_t remaining = k % select_sample;
+    while(true) {
+        size_t word_ones = std::popcount(bits);
+        if(remaining < word_ones) return word * 64 + select_in_word(bits, remaining);
+        remaining -= word_ones;
+        bits = this->high_bits[++word];
+    }
+}
+
+template <typename T>
+size_t EliasFanoSet<T>::select_zero(size_t k) const {
+    size_t position = this->zero_samples[k / select_sample];
+    size_t word = position / 64;
+    uint64_t bits = ~this->high_bits[word] & (~uint64_t(0) << (position % 64));
+    size_t remaining = k % select_sample;
+    while(true) {
+        size_t word_zeros = std::popcount(bits);
+        if(remaining < word_zeros) return word * 64 + select_in_word(bits, remaining);
+        remaining -= word_zeros;
+        bits = ~this->high_bits[++word];
+    }
+}
+
+template <typename T>
+size_t EliasFanoSet<T>::next_one(size_t position) const {
+    size_t word = position / 64;
+    uint64_t bits = this->high_bits[word] & (~uint64_t(0) << (position % 64));
+    while(bits == 0) bits = this->high_bits[++word];
+    return word * 64 + std::countr_zero(bits);
+}
+
+template <typename T>
+size_t EliasFanoSet<T>::prev_one(size_t position) const {
+    size_t word = position / 64;
+    uint64_t bits = this->high_bits[word] & (~uint64_t(0) >> (63 - position % 64));
+    while(bits == 0) bits = this->high_bits[--word];
+    return word * 64 + 63 - std::countl_zero(bits);
+}
+
+// The zero closing bucket (value >> low_width) - 1 sits right before the first key with those high bits.
+template <typename T>
+typename EliasFanoSet<T>::iterator EliasFanoSet<T>::lower_bound(T value) const {
+    uint64_t high = static_cast<uint64_t>(value) >> this->low_width;
+    if(this->count == 0 || high > this->max_high) return this->end();
+    size_t position = high == 0 ? 0 : this->select_zero(high - 1) + 1;
+    iterator it(this, position - high, this->next_one(position));
+    while(it != this->end() && *it < value) ++it;
+    return it;
+}
+
+template <typename T>
+typename EliasFanoSet<T>::iterator EliasFanoSet<T>::successor_find(T value) const {
+    return this->lower_bound(value);
+}
+
+template <typename T>
+typename EliasFanoSet<T>::iterator EliasFanoSet<T>::find(T value) const {
+    iterator it = this->lower_bound(value);
+    if(it == this->end() || *it != value) return this->end();
+    return it;
+}
+
+template <typename T>
+typename EliasFanoSet<T>::iterator EliasFanoSet<T>::predecessor_find(T value) const {
+    iterator it = this->lower_bound(value);
+    if(it != this->end() && *it == value) return it;
+    if(it.get_rank() == 0) return this->end();
+    return --it;
+}
+
+template <typename T>
+bool EliasFanoSet<T>::contains(T value) const {
+    return this->find(value) != this->end();
+}
+
+template <typename T>
+size_t EliasFanoSet<T>::rank(T value) const {
+    return this->lower_bound(value).get_rank();
+}
+
+template <typename T>
+T EliasFanoSet<T>::select(size_t index) const {
+    return *iterator(this, index, this->select_one(index));
+}
+
+template <typename T>
+size_t EliasFanoSet<T>::size() const {
+    return this->count;
+}
+
+template <typename T>
+size_t EliasFanoSet<T>::size_in_bytes() const {
+    return sizeof(*this) + (this->low_bits.capacity() + this->high_bits.capacity()) * sizeof(uint64_t) +
+           (this->one_samples.capacity() + this->zero_samples.capacity()) * sizeof(size_t);
+}
+
+template <typename T>
+typename EliasFanoSet<T>::iterator EliasFanoSet<T>::begin() const {
+    if(this->count == 0) return this->end();
+    return iterator(this, 0, this->next_one(0));
+}
+
+template <typename T>
+typename EliasFanoSet<T>::iterator EliasFanoSet<T>::end() const {
+    return iterator(this, this->count, 0);
+}
+
+template <typename T>
+EliasFanoSet<T>::Iterator::Iterator(const EliasFanoSet *set, size_t index, size_t position)
+        : set(set), index(index), position(position) {}
+
+template <typename T>
+typename EliasFanoSet<T>::Iterator &EliasFanoSet<T>::Iterator::operator++() {
+    if(++this->index < this->set->count) this->position = this->set->next_one(this->position + 1);
+    else this->position = 0;
+    return *this;
+}
+
+template <typename T>
+typename EliasFanoSet<T>::Iterator EliasFanoSet<T>::Iterator::operator++(int) {
+    Iterator temp = *this;
+    ++*this;
+    return temp;
+}
+
+template <typename T>
+typename EliasFanoSet<T>::Iterator &EliasFanoSet<T>::Iterator::operator--() {
+    if(this->index == this->set->count) this->position = this->set->select_one(this->index - 1);
+    else this->position = this->set->prev_one(this->position - 1);
+    this->index--;
+    return *this;
+}
+
+template <typename T>
+typename EliasFanoSet<T>::Iterator EliasFanoSet<T>::Iterator::operator--(int) {
+    Iterator temp = *this;
+    --*this;
+    return temp;
+}
+
+template <typename T>
+T EliasFanoSet<T>::Iterator::operator*() const {
+    uint64_t high = this->position - this->index;
+    return static_cast<T>((high << this->set->low_width) | this->set->low(this->index));
+}
+
+template <typename T>
+bool EliasFanoSet<T>::Iterator::operator==(const Iterator &other) const {
+    return this->index == other.index;
+}
+
+template <typename T>
+bool EliasFanoSet<T>::Iterator::operator!=(const Iterator &other) const {
+    return this->index != other.index;
+}
+
+template <typename T>
+size_t EliasFanoSet<T>::Iterator::get_rank() const {
+    return this->index;
+}
+
+template class EliasFanoSet<unsigned int>;
+template class EliasFanoSet<unsigned long long>;
+template class EliasFanoSet<unsigned short>;
+template class EliasFanoSet<unsigned char>;
+
+#endif //BINARY_SEARCH_TREES_ELIAS_FANO_H
@@ -0,0 +1,132 @@
+#ifndef BINARY_SEARCH_TREES_INTERVAL_H
+#define BINARY_SEARCH_TREES_INTERVAL_H
+
+#include "avl.h"
+#include <compare>
+
+// Closed interval [low, high]; ordered by low endpoint, then by high endpoint.
+template <typename T>
+struct Interval {
+    T low;
+    T high;
+
+    auto operator<=>(const Interval &other) const = default;
+    [[nodiscard]] bool overlaps(const T &low, const T &high) const;
+};
+
+template <typename T>
+bool Interval<T>::overlaps(const T &low, const T &high) const {
+    return !(high < this->low) && !(this->high < low);
+}
+
+// AVL tree of intervals where every node also keeps the largest high endpoint of its subtree, so overlap and
+// stabbing queries prune whole subtrees and run in O(log n + k). Intervals are expected to have low <= high.
+template <typename T, typename Allocator = std::allocator<Interval<T>>>
+class IntervalTree : public AVLTree<Interval<T>, Allocator> {
+private:
+    using Node = typename BinarySearchTree<Interval<T>, Allocator>::Node;
+    template <typename U>
+    using vector = typename BinarySearchTree<Interval<T>, Allocator>::template vector<U>;
+    vector<T> max_high;     // by node index, valid for live node indices only
+public:
+    explicit IntervalTree(const Allocator &allocator = Allocator());
+
+    explicit IntervalTree(std::vector<Interval<T>> values, const Allocator &allocator = Allocator());
+
+    // Calls fn for every stored interval intersecting [low, high], in order.
+    template <typename Function>
+    void overlapping(const T &low, const T &high, Function fn) const;
+
+    // Calls fn for every stored interval containing point, in order.
+    template <typename Function>
+    void stab(const T &point, Function fn) const;
+
+protected:
+    void update_node(Node &node) override;
+
+    void swap_nodes(size_t first, size_t second) override;
+
+private:
+    template <typename Function>
+    void overlapping(size_t index, const T &low, const T &high, Function &fn) const;
+};
+
+template <typename T, typename Allocator>
+IntervalTree<T, Allocator>::IntervalTree(const Allocator &allocator) : AVLTree<Interval<T>, Allocator>(allocator),
+                                                                       max_high(allocator) {}
+
+template <typename T, typename Allocator>
+IntervalTree<T, Allocator>::IntervalTree(std::vector<Interval<T>> values, const Allocator &allocator)
+        : IntervalTree(allocator) {
+    for(const auto &value : values) {
+        this->insert(value);
+    }
+}
+
+template <typename T, typename Allocator>
+void IntervalTree<T, Allocator>::update_node(Node &node) {
+    size_t index = node.get_node_index();
+    if(this->max_high.size() <= index) this->max_high.resize(index + 1);
+    T high = node.get_value().high;
+    if(node.has_left()) high = std::max(high, this->max_high[node.get_left_index()]);
+    if(node.has_right()) high = std::max(high, this->max_high[node.get_right_index()]);
+    this->max_high[index] = high;
+}
+
+template <typename T, typename Allocator>
+void IntervalTree<T, Allocator>::swap_nodes(size_t first, size_t second) {
+    AVLTree<Interval<T>, Allocator>::swap_nodes(first, second);
+    std::swap(this->max_high[first], this->max_high[second]);
+}
+
+template <typename T, typename Allocator>
+template <typename Function>
+void IntervalTree<T, Allocator>::overlapping(const T &low, const T &high, Function fn) const {
+    if(this->empty()) return;
+    this->overlapping(this->root().get_node_index(), low, high, fn);
+}
+
+template <typename T, typename Allocator>
+template <typename Function>
+void IntervalTree<T, Allocator>::stab(const T &point, Function fn) const {
+    this->overlapping(point, point, fn);
+}
+
+// A subtree whose largest high endpoint is below low holds no match; neither does anything right of a node
+// starting after high, since every interval there starts at least as late.
+template <typename T, typename Allocator>
+template <typename Function>
+void IntervalTree<T, Allocator>::overlapping(size_t index, const T &low, const T &high, Function &fn) const {
+    if(this->max_high[index] < low) return;
+    const Node &node = this->at(index);
+    if(node.has_left()) this->overlapping(node.get_left_index(), low, high, fn);
+    const Interval<T> interval = node.get_value();
+    if(high < interval.low) return;
+    if(interval.overlaps(low, high)) fn(interval);
+    if(node.has_right()) this->overlapping(node.get_right_index(), low, high, fn);
+}
+
+template
+class IntervalTree<int>;
+
+template
+class IntervalTree<float>;
+
+template
+class IntervalTree<double>;
+
+template
+class IntervalTree<unsigned int>;
+
+template
+class IntervalTree<unsigned long long>;
+
+template
+class IntervalTree<long long>;
+
+namespace pmr {
+    template <typename T>
+    using IntervalTree = ::IntervalTree<T, std::pmr::polymorphic_allocator<Interval<T>>>;
+}
+
+#endif //BINARY_SEARCH_TREES_INTERVAL_H
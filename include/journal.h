@@ -0,0 +1,508 @@
+#ifndef BINARY_SEARCH_TREES_JOURNAL_H
+#define BINARY_SEARCH_TREES_JOURNAL_H
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <exception>
+#include <concepts>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+struct JournalOptions {
+    std::chrono::microseconds max_commit_latency{2000};     // oldest unsynced record waits at most this long
+    size_t max_batch_bytes = 1 << 20;                       // a batch this large is committed right away
+    size_t compact_log_bytes = 64 << 20;                    // log size at which a checkpoint is taken
+};
+
+class JournalCorrupted : public std::exception {
+public:
+    explicit JournalCorrupted(const std::string &file) : message("Journal file '" + file + "' is corrupted") {}
+    [[nodiscard]] const char *what() const noexcept override {
+        return this->message.c_str();
+    }
+private:
+    std::string message;
+};
+
+constexpr std::array<uint32_t, 256> journal_crc_table() {
+    std::array<uint32_t, 256> table{};
+    for(uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for(int bit = 0; bit < 8; bit++) crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        table[i] = crc;
+    }
+    return table;
+}
+
+inline uint32_t journal_crc(const char *data, size_t size, uint32_t crc = 0) {
+    static constexpr std::array<uint32_t, 256> table = journal_crc_table();
+    crc = ~crc;
+    for(size_t i = 0; i < size; i++) crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// What JournaledTree calls on its engine: plain and hinted inserts for replaying the log and the checkpoint,
+// for_each for taking one, and the read side it forwards. The BinarySearchTree engines all qualify.
+template <typename Tree>
+concept Journalable = requires(Tree &tree, const typename Tree::iterator::DataType &value) {
+    { tree.insert(value).second } -> std::convertible_to<bool>;
+    tree.insert(tree.end(), value);
+    tree.remove(value);
+    { tree.size() } -> std::convertible_to<size_t>;
+    tree.for_each([](const typename Tree::iterator::DataType &) {});
+    { tree.find(value) } -> std::same_as<typename Tree::iterator>;
+    { tree.predecessor_find(value) } -> std::same_as<typename Tree::iterator>;
+    { tree.successor_find(value) } -> std::same_as<typename Tree::iterator>;
+    { tree.begin() } -> std::same_as<typename Tree::iterator>;
+};
+
+// Durability for any Journalable tree engine. Every insert and remove is appended to a log as a checksummed record and
+// becomes durable at the next group commit, which a background thread issues once the oldest pending record has
+// waited max_commit_latency or max_batch_bytes have piled up; sync() waits for it. When the log outgrows
+// compact_log_bytes the tree is snapshotted, new records go to a fresh log, and the background thread writes the
+// snapshot as a checkpoint and drops the old log.
+//
+// On disk: <path>.checkpoint holds the generation of the first log it does not cover plus the sorted values, and
+// <path>.log.<generation> holds the records. Opening replays the checkpoint with hinted appends, then every log from
+// that generation on; a torn record at the end of the last log is cut off.
+template <typename Tree>
+requires Journalable<Tree>
+class JournaledTree {
+public:
+    using value_type = typename Tree::iterator::DataType;
+    using iterator = typename Tree::iterator;
+    static_assert(std::is_trivially_copyable_v<value_type>, "JournaledTree stores values as raw bytes");
+
+    template <typename... TreeArgs>
+    explicit JournaledTree(std::filesystem::path path, JournalOptions options = JournalOptions(),
+                           TreeArgs &&...tree_args);
+    JournaledTree(const JournaledTree &) = delete;
+    JournaledTree &operator=(const JournaledTree &) = delete;
+    ~JournaledTree();
+    std::pair<iterator, bool> insert(const value_type &value);
+    void remove(const value_type &value);
+    iterator find(const value_type &value);
+    iterator predecessor_find(const value_type &value);
+    iterator successor_find(const value_type &value);
+    [[nodiscard]] size_t size() const;
+    iterator begin();
+    iterator end();
+    template <typename Function>
+    void for_each(Function fn) const;
+    void sync();
+    void compact();
+
+private:
+    enum class Operation : char {
+        insert = 1,
+        remove = 2,
+    };
+    static constexpr size_t record_size = 1 + sizeof(value_type) + sizeof(uint32_t);
+    static constexpr char checkpoint_magic[8] = {'B', 'S', 'T', 'C', 'K', 'P', 'T', '1'};
+    struct Snapshot {
+        std::vector<value_type> values;
+        std::vector<char> old_log_tail;     // records of the old generation not yet written
+        uint64_t old_log_sequence = 0;
+        uint64_t generation = 0;            // first generation the checkpoint does not cover
+    };
+
+    Tree tree;
+    std::filesystem::path path;
+    JournalOptions options;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable committed;
+    std::vector<char> pending;
+    std::vector<char> writing;
+    std::chrono::steady_clock::time_point first_pending;
+    uint64_t appended_sequence = 0;
+    uint64_t durable_sequence = 0;
+    size_t sync_waiters = 0;
+    uint64_t generation = 0;
+    size_t log_bytes = 0;
+    bool compacting = false;
+    bool snapshot_ready = false;
+    Snapshot snapshot;
+    bool stopping = false;
+    std::exception_ptr error;
+    int log_fd = -1;
+    std::thread worker;
+
+private:
+    [[nodiscard]] std::filesystem::path log_path(uint64_t log_generation) const;
+    [[nodiscard]] std::filesystem::path checkpoint_path() const;
+    void recover();
+    [[nodiscard]] uint64_t load_checkpoint();
+    void replay_log(const std::filesystem::path &file, bool last);
+    void append(Operation operation, const value_type &value);
+    void run();
+    void write_checkpoint(const Snapshot &checkpoint);
+    static void write_all(int fd, const char *data, size_t size);
+    static void sync_directory(const std::filesystem::path &directory);
+    static int open_log(const std::filesystem::path &file);
+    static void throw_errno(const std::string &what);
+};
+
+template <typename Tree>
+requires Journalable<Tree>
+template <typename... TreeArgs>
+JournaledTree<Tree>::JournaledTree(std::filesystem::path path, JournalOptions options, TreeArgs &&...tree_args)
+        : tree(std::forward<TreeArgs>(tree_args)...), path(std::move(path)), options(options) {
+    this->recover();
+    this->log_fd = open_log(this->log_path(this->generation));
+    this->log_bytes = static_cast<size_t>(std::filesystem::file_size(this->log_path(this->generation)));
+    this->worker = std::thread(&JournaledTree::run, this);
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+JournaledTree<Tree>::~JournaledTree() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+    if(this->worker.joinable()) this->worker.join();
+    if(this->log_fd >= 0) ::close(this->log_fd);
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+std::filesystem::path JournaledTree<Tree>::log_path(uint64_t log_generation) const {
+    return this->path.string() + ".log." + std::to_string(log_generation);
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+std::filesystem::path JournaledTree<Tree>::checkpoint_path() const {
+    return this->path.string() + ".checkpoint";
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+void JournaledTree<Tree>::recover() {
+    uint64_t first_generation = this->load_checkpoint();
+    for(uint64_t stale = first_generation; stale > 0 && std::filesystem::exists(this->log_path(stale - 1)); stale--) {
+        std::filesystem::remove(this->log_path(stale - 1));
+    }
+    this->generation = first_generation;
+    while(std::filesystem::exists(this->log_path(this->generation + 1))) {
+        this->replay_log(this->log_path(this->generation), false);
+        this->generation++;
+    }
+    if(std::filesystem::exists(this->log_path(this->generation))) this->replay_log(this->log_path(this->generation), true);
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+uint64_t JournaledTree<Tree>::load_checkpoint() {
+    std::ifstream in(this->checkpoint_path(), std::ios::binary);
+    if(!in) return 0;
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size_t header_size = sizeof(checkpoint_magic) + 2 * sizeof(uint64_t);
+    if(bytes.size() < header_size + sizeof(uint32_t) ||
+       std::memcmp(bytes.data(), checkpoint_magic, sizeof(checkpoint_magic)) != 0) {
+        throw JournalCorrupted(this->checkpoint_path().string());
+    }
+    uint64_t first_generation, count;
+    uint32_t crc;
+    std::memcpy(&first_generation, bytes.data() + sizeof(checkpoint_magic), sizeof(uint64_t));
+    std::memcpy(&count, bytes.data() + sizeof(checkpoint_magic) + sizeof(uint64_t), sizeof(uint64_t));
+    if(bytes.size() != header_size + count * sizeof(value_type) + sizeof(uint32_t)) {
+        throw JournalCorrupted(this->checkpoint_path().string());
+    }
+    std::memcpy(&crc, bytes.data() + bytes.size() - sizeof(uint32_t), sizeof(uint32_t));
+    if(crc != journal_crc(bytes.data(), bytes.size() - sizeof(uint32_t))) {
+        throw JournalCorrupted(this->checkpoint_path().string());
+    }
+
+    // Checkpoints are written in order, so every value goes straight to the end of the tree.
+    for(uint64_t i = 0; i < count; i++) {
+        value_type value;
+        std::memcpy(&value, bytes.data() + header_size + i * sizeof(value_type), sizeof(value_type));
+        this->tree.insert(this->tree.end(), value);
+    }
+    return first_generation;
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+void JournaledTree<Tree>::replay_log(const std::filesystem::path &file, bool last) {
+    std::ifstream in(file, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    size_t offset = 0;
+    for(; offset + record_size <= bytes.size(); offset += record_size) {
+        const char *record = bytes.data() + offset;
+        uint32_t crc;
+        std::memcpy(&crc, record + 1 + sizeof(value_type), sizeof(uint32_t));
+        if(crc != journal_crc(record, 1 + sizeof(value_type))) break;
+        value_type value;
+        std::memcpy(&value, record + 1, sizeof(value_type));
+        if(static_cast<Operation>(record[0]) == Operation::insert) this->tree.insert(value);
+        else if(static_cast<Operation>(record[0]) == Operation::remove) this->tree.remove(value);
+        else break;
+    }
+    if(offset == bytes.size()) return;
+    // Only the last log can end in a torn write; anything else was synced before its successor existed.
+    if(!last) throw JournalCorrupted(file.string());
+    std::filesystem::resize_file(file, offset);
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+int JournaledTree<Tree>::open_log(const std::filesystem::path &file) {
+    int fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if(fd < 0) throw_errno("open " + file.string());
+    sync_directory(file.parent_path());
+    return fd;
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+void JournaledTree<Tree>::throw_errno(const std::string &what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+void JournaledTree<Tree>::write_all(int fd, const char *data, size_t size) {
+    while(size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if(written < 0) {
+            if(errno == EINTR) continue;
+            throw_errno("write");
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+void JournaledTree<Tree>::sync_directory(const std::filesystem::path &directory) {
+    int fd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if(fd < 0) throw_errno("open " + directory.string());
+    ::fsync(fd);
+    ::close(fd);
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+std::pair<typename JournaledTree<Tree>::iterator, bool> JournaledTree<Tree>::insert(const value_type &value) {
+    auto result = this->tree.insert(value);
+    if(result.second) this->append(Operation::insert, value);
+    return result;
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+void JournaledTree<Tree>::remove(const value_type &value) {
+    size_t size = this->tree.size();
+    this->tree.remove(value);
+    if(this->tree.size() != size) this->append(Operation::remove, value);
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+void JournaledTree<Tree>::append(Operation operation, const value_type &value) {
+    std::array<char, record_size> record;
+    record[0] = static_cast<char>(operation);
+    std::memcpy(record.data() + 1, &value, sizeof(value_type));
+    uint32_t crc = journal_crc(record.data(), 1 + sizeof(value_type));
+    std::memcpy(record.data() + 1 + sizeof(value_type), &crc, sizeof(uint32_t));
+
+    bool notify;
+    bool compact;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if(this->error) std::rethrow_exception(this->error);
+        if(this->pending.empty()) this->first_pending = std::chrono::steady_clock::now();
+        this->pending.insert(this->pending.end(), record.begin(), record.end());
+        this->appended_sequence++;
+        this->log_bytes += record_size;
+        notify = this->pending.size() == record_size || this->pending.size() >= this->options.max_batch_bytes;
+        compact = !this->compacting && this->log_bytes >= this->options.compact_log_bytes;
+    }
+    if(notify) this->wake.notify_one();
+    if(compact) this->compact();
+}
+
+// The snapshot is copied here, since the tree is not safe to read while the caller keeps changing it; writing it
+// out and dropping the old log happen on the background thread.
+template <typename Tree>
+requires Journalable<Tree>
+void JournaledTree<Tree>::compact() {
+    std::vector<value_type> values;
+    values.reserve(this->tree.size());
+    this->tree.for_each([&values](const value_type &value) { values.push_back(value); });
+    {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->committed.wait(lock, [this] { return !this->compacting || this->error; });
+        if(this->error) std::rethrow_exception(this->error);
+        this->compacting = true;
+        this->snapshot_ready = true;
+        this->snapshot.values = std::move(values);
+        this->snapshot.old_log_tail = std::move(this->pending);
+        this->snapshot.old_log_sequence = this->appended_sequence;
+        this->snapshot.generation = ++this->generation;
+        this->pending.clear();
+        this->log_bytes = 0;
+    }
+    this->wake.notify_one();
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+void JournaledTree<Tree>::sync() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    uint64_t target = this->appended_sequence;
+    this->sync_waiters++;
+    this->wake.notify_one();
+    this->committed.wait(lock, [this, target] { return this->durable_sequence >= target || this->error; });
+    this->sync_waiters--;
+    if(this->error) std::rethrow_exception(this->error);
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+void JournaledTree<Tree>::run() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    while(true) {
+        auto ready = [this] {
+            return this->stopping || this->snapshot_ready || (!this->pending.empty() && (this->sync_waiters > 0 ||
+                   this->pending.size() >= this->options.max_batch_bytes));
+        };
+        if(this->pending.empty()) this->wake.wait(lock, [&] { return ready() || !this->pending.empty(); });
+        else this->wake.wait_until(lock, this->first_pending + this->options.max_commit_latency, ready);
+
+        try {
+            if(this->snapshot_ready) {
+                Snapshot checkpoint = std::move(this->snapshot);
+                this->snapshot_ready = false;
+                lock.unlock();
+                write_all(this->log_fd, checkpoint.old_log_tail.data(), checkpoint.old_log_tail.size());
+                if(::fdatasync(this->log_fd) != 0) throw_errno("fdatasync");
+                int next_fd = open_log(this->log_path(checkpoint.generation));
+                lock.lock();
+                std::swap(this->log_fd, next_fd);
+                this->durable_sequence = std::max(this->durable_sequence, checkpoint.old_log_sequence);
+                this->committed.notify_all();
+                lock.unlock();
+                ::close(next_fd);
+                this->write_checkpoint(checkpoint);
+                std::filesystem::remove(this->log_path(checkpoint.generation - 1));
+                lock.lock();
+                this->compacting = false;
+                this->committed.notify_all();
+            }
+
+            if(!this->pending.empty()) {
+                std::swap(this->pending, this->writing);
+                uint64_t sequence = this->appended_sequence;
+                lock.unlock();
+                write_all(this->log_fd, this->writing.data(), this->writing.size());
+                if(::fdatasync(this->log_fd) != 0) throw_errno("fdatasync");
+                this->writing.clear();
+                lock.lock();
+                this->durable_sequence = std::max(this->durable_sequence, sequence);
+                this->committed.notify_all();
+            }
+        }
+        catch(...) {
+            if(!lock.owns_lock()) lock.lock();
+            this->error = std::current_exception();
+            this->committed.notify_all();
+            return;
+        }
+        if(this->stopping && this->pending.empty() && !this->snapshot_ready) return;
+    }
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+void JournaledTree<Tree>::write_checkpoint(const Snapshot &checkpoint) {
+    std::vector<char> bytes(sizeof(checkpoint_magic) + 2 * sizeof(uint64_t) +
+                            checkpoint.values.size() * sizeof(value_type));
+    uint64_t count = checkpoint.values.size();
+    std::memcpy(bytes.data(), checkpoint_magic, sizeof(checkpoint_magic));
+    std::memcpy(bytes.data() + sizeof(checkpoint_magic), &checkpoint.generation, sizeof(uint64_t));
+    std::memcpy(bytes.data() + sizeof(checkpoint_magic) + sizeof(uint64_t), &count, sizeof(uint64_t));
+    if(count > 0) {
+        std::memcpy(bytes.data() + sizeof(checkpoint_magic) + 2 * sizeof(uint64_t), checkpoint.values.data(),
+                    count * sizeof(value_type));
+    }
+    uint32_t crc = journal_crc(bytes.data(), bytes.size());
+
+    std::filesystem::path temporary = this->checkpoint_path().string() + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0) throw_errno("open " + temporary.string());
+    write_all(fd, bytes.data(), bytes.size());
+    write_all(fd, reinterpret_cast<const char *>(&crc), sizeof(uint32_t));
+    if(::fsync(fd) != 0) {
+        ::close(fd);
+        throw_errno("fsync " + temporary.string());
+    }
+    ::close(fd);
+    std::filesystem::rename(temporary, this->checkpoint_path());
+    sync_directory(this->checkpoint_path().parent_path());
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+typename JournaledTree<Tree>::iterator JournaledTree<Tree>::find(const value_type &value) {
+    return this->tree.find(value);
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+typename JournaledTree<Tree>::iterator JournaledTree<Tree>::predecessor_find(const value_type &value) {
+    return this->tree.predecessor_find(value);
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+typename JournaledTree<Tree>::iterator JournaledTree<Tree>::successor_find(const value_type &value) {
+    return this->tree.successor_find(value);
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+size_t JournaledTree<Tree>::size() const {
+    return this->tree.size();
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+typename JournaledTree<Tree>::iterator JournaledTree<Tree>::begin() {
+    return this->tree.begin();
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+typename JournaledTree<Tree>::iterator JournaledTree<Tree>::end() {
+    return this->tree.end();
+}
+
+template <typename Tree>
+requires Journalable<Tree>
+template <typename Function>
+void JournaledTree<Tree>::for_each(Function fn) const {
+    this->tree.for_each(fn);
+}
+
+#endif //BINARY_SEARCH_TREES_JOURNAL_H
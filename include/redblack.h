@@ -0,0 +1,243 @@
+#ifndef BINARY_SEARCH_TREES_REDBLACK_H
+#define BINARY_SEARCH_TREES_REDBLACK_H
+
+#include "bst.h"
+
+template <typename T, typename Allocator = std::allocator<T>>
+class RedBlackTree : public BinarySearchTree<T, Allocator> {
+public:
+    using iterator = typename RedBlackTree<T, Allocator>::iterator;
+    explicit RedBlackTree(const Allocator &allocator = Allocator());
+    explicit RedBlackTree(std::vector<T> values, const Allocator &allocator = Allocator());
+    std::pair<iterator, bool> insert(const T &value) override;
+    iterator insert(iterator hint, const T &value) override;
+    void remove(const T &value) override;
+
+private:
+    using Node = typename BinarySearchTree<T, Allocator>::Node;
+    using restricted_iterator = typename BinarySearchTree<T, Allocator>::restricted_iterator;
+private:
+    [[nodiscard]] bool is_red(size_t index) const;
+    void left_rotate(Node &node);
+    void right_rotate(Node &node);
+    Node &insert_node(Node &parent, bool left, const T &value);
+    void insert_fixup(Node &node);
+    void remove_fixup(size_t index, size_t parent_index);
+    void transplant(Node &node, size_t child_index);
+};
+
+template <typename T, typename Allocator>
+RedBlackTree<T, Allocator>::RedBlackTree(const Allocator &allocator) : BinarySearchTree<T, Allocator>(allocator) {}
+
+template <typename T, typename Allocator>
+RedBlackTree<T, Allocator>::RedBlackTree(std::vector<T> values, const Allocator &allocator) : RedBlackTree(allocator) {
+    for(auto value : values) {
+        this->insert(value);
+    }
+}
+
+template <typename T, typename Allocator>
+bool RedBlackTree<T, Allocator>::is_red(size_t index) const {
+    return index != 0 && this->at(index).is_red();
+}
+
+template <typename T, typename Allocator>
+void RedBlackTree<T, Allocator>::left_rotate(Node &node) {
+    Node &right_child = node.right();
+    node.set_right_index(right_child.get_left_index());
+    if(right_child.has_left()) right_child.left().set_parent_index(node.get_node_index());
+    right_child.set_parent_index(node.get_parent_index());
+    if(node.is_left_sibling()) node.parent().set_left_index(right_child.get_node_index());
+    else node.parent().set_right_index(right_child.get_node_index());
+    right_child.set_left_index(node.get_node_index());
+    node.set_parent_index(right_child.get_node_index());
+}
+
+template <typename T, typename Allocator>
+void RedBlackTree<T, Allocator>::right_rotate(Node &node) {
+    Node &left_child = node.left();
+    node.set_left_index(left_child.get_right_index());
+    if(left_child.has_right()) left_child.right().set_parent_index(node.get_node_index());
+    left_child.set_parent_index(node.get_parent_index());
+    if(node.is_left_sibling()) node.parent().set_left_index(left_child.get_node_index());
+    else node.parent().set_right_index(left_child.get_node_index());
+    left_child.set_right_index(node.get_node_index());
+    node.set_parent_index(left_child.get_node_index());
+}
+
+template <typename T, typename Allocator>
+std::pair<typename RedBlackTree<T, Allocator>::iterator, bool> RedBlackTree<T, Allocator>::insert(const T &value) {
+    auto [parent, left, exists] = this->find_insert_position(value);
+    if(exists) return {iterator(*parent), false};
+    return {iterator(this->insert_node(*parent, left, value)), true};
+}
+
+template <typename T, typename Allocator>
+typename RedBlackTree<T, Allocator>::iterator RedBlackTree<T, Allocator>::insert(iterator hint, const T &value) {
+    auto [parent, left, exists] = this->find_insert_position(hint, value);
+    if(exists) return iterator(*parent);
+    return iterator(this->insert_node(*parent, left, value));
+}
+
+template <typename T, typename Allocator>
+typename RedBlackTree<T, Allocator>::Node &RedBlackTree<T, Allocator>::insert_node(Node &parent, bool left, const T &value) {
+    Node &new_node = this->attach(parent, left, value);
+    new_node.set_red(true);
+    this->insert_fixup(new_node);
+    return new_node;
+}
+
+// At most two rotations: recolouring moves the violation up, a rotation always ends the loop.
+template <typename T, typename Allocator>
+void RedBlackTree<T, Allocator>::insert_fixup(Node &node) {
+    Node *node_ptr = &node;
+    while(!node_ptr->parent().is_end_node() && node_ptr->parent().is_red()) {
+        Node *parent = &node_ptr->parent();
+        Node &grandparent = parent->parent();
+        if(parent->is_left_sibling()) {
+            if(this->is_red(grandparent.get_right_index())) {
+                parent->set_red(false);
+                grandparent.right().set_red(false);
+                grandparent.set_red(true);
+                node_ptr = &grandparent;
+                continue;
+            }
+            if(node_ptr->is_right_sibling()) {
+                node_ptr = parent;
+                this->left_rotate(*node_ptr);
+                parent = &node_ptr->parent();
+            }
+            parent->set_red(false);
+            grandparent.set_red(true);
+            this->right_rotate(grandparent);
+        }
+        else {
+            if(this->is_red(grandparent.get_left_index())) {
+                parent->set_red(false);
+                grandparent.left().set_red(false);
+                grandparent.set_red(true);
+                node_ptr = &grandparent;
+                continue;
+            }
+            if(node_ptr->is_left_sibling()) {
+                node_ptr = parent;
+                this->right_rotate(*node_ptr);
+                parent = &node_ptr->parent();
+            }
+            parent->set_red(false);
+            grandparent.set_red(true);
+            this->left_rotate(grandparent);
+        }
+    }
+    this->root().set_red(false);
+}
+
+template <typename T, typename Allocator>
+void RedBlackTree<T, Allocator>::transplant(Node &node, size_t child_index) {
+    Node &parent = node.parent();
+    if(node.is_left_sibling()) parent.set_left_index(child_index);
+    else parent.set_right_index(child_index);
+    if(child_index != 0) this->at(child_index).set_parent_index(parent.get_node_index());
+}
+
+template <typename T, typename Allocator>
+void RedBlackTree<T, Allocator>::remove(const T &value) {
+    restricted_iterator it = this->lookup(value);
+    if(it == this->end()) return;
+    this->filter_remove(value);
+    Node *node = &it.get_node();
+    if(node->has_left() && node->has_right()) {
+        it++;
+        Node &next = it.get_node();
+        node->set_value(next.get_value());
+        node = &next;
+    }
+
+    size_t child_index = node->has_left() ? node->get_left_index() : node->get_right_index();
+    size_t parent_index = node->get_parent_index();
+    this->unlink_extremes(*node);
+    this->transplant(*node, child_index);
+    if(!node->is_red()) {
+        if(this->is_red(child_index)) this->at(child_index).set_red(false);
+        else this->remove_fixup(child_index, parent_index);
+    }
+    this->pop(*node);
+}
+
+// Runs while the spliced-out node is still allocated so no index moves under it. At most three rotations.
+template <typename T, typename Allocator>
+void RedBlackTree<T, Allocator>::remove_fixup(size_t index, size_t parent_index) {
+    while(parent_index != 0 && !this->is_red(index)) {
+        Node *parent = &this->at(parent_index);
+        if(parent->get_left_index() == index) {
+            Node *sibling = &parent->right();
+            if(sibling->is_red()) {
+                sibling->set_red(false);
+                parent->set_red(true);
+                this->left_rotate(*parent);
+                sibling = &parent->right();
+            }
+            if(!this->is_red(sibling->get_left_index()) && !this->is_red(sibling->get_right_index())) {
+                sibling->set_red(true);
+                index = parent_index;
+                parent_index = parent->get_parent_index();
+                continue;
+            }
+            if(!this->is_red(sibling->get_right_index())) {
+                sibling->left().set_red(false);
+                sibling->set_red(true);
+                this->right_rotate(*sibling);
+                sibling = &parent->right();
+            }
+            sibling->set_red(parent->is_red());
+            parent->set_red(false);
+            sibling->right().set_red(false);
+            this->left_rotate(*parent);
+        }
+        else {
+            Node *sibling = &parent->left();
+            if(sibling->is_red()) {
+                sibling->set_red(false);
+                parent->set_red(true);
+                this->right_rotate(*parent);
+                sibling = &parent->left();
+            }
+            if(!this->is_red(sibling->get_left_index()) && !this->is_red(sibling->get_right_index())) {
+                sibling->set_red(true);
+                index = parent_index;
+                parent_index = parent->get_parent_index();
+                continue;
+            }
+            if(!this->is_red(sibling->get_left_index())) {
+                sibling->right().set_red(false);
+                sibling->set_red(true);
+                this->left_rotate(*sibling);
+                sibling = &parent->left();
+            }
+            sibling->set_red(parent->is_red());
+            parent->set_red(false);
+            sibling->left().set_red(false);
+            this->right_rotate(*parent);
+        }
+        index = this->root().get_node_index();
+        break;
+    }
+    if(index != 0) this->at(index).set_red(false);
+}
+
+template class RedBlackTree<int>;
+template class RedBlackTree<float>;
+template class RedBlackTree<double>;
+template class RedBlackTree<unsigned int>;
+template class RedBlackTree<unsigned long long>;
+template class RedBlackTree<long long>;
+template class RedBlackTree<short>;
+template class RedBlackTree<char>;
+template class RedBlackTree<unsigned char>;
+
+namespace pmr {
+    template <typename T>
+    using RedBlackTree = ::RedBlackTree<T, std::pmr::polymorphic_allocator<T>>;
+}
+
+#endif //BINARY_SEARCH_TREES_REDBLACK_H
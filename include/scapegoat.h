@@ -5,164 +5,796 @@
 #include <stack>
 #include <cmath>
 #include <tuple>
+#include <algorithm>
+#include <thread>
+#include <limits>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <array>
 
-template <typename T>
-class ScapegoatTree : public BinarySearchTree<T> {
+struct AlphaTuning {
+    double min_alpha = .5;
+    double max_alpha = .8;
+    double step = .05;
+    size_t window = 4096;           // operations in the sliding window alpha is tuned from
+    double rebuild_budget = 8;      // rebuilt nodes per write tolerated before alpha is loosened
+};
+
+enum class AlphaChangeReason {
+    none,
+    read_heavy,
+    write_heavy,
+    rebuild_cost,
+};
+
+struct AlphaChange {
+    double previous_alpha = 0;
+    double alpha = 0;
+    AlphaChangeReason reason = AlphaChangeReason::none;
+    size_t reads = 0;
+    size_t writes = 0;
+    size_t rebuilt_nodes = 0;
+};
+
+template <typename T, typename Allocator = std::allocator<T>>
+class ScapegoatTree : public BinarySearchTree<T, Allocator> {
 public:
-    using iterator = typename ScapegoatTree<T>::iterator;
-    explicit ScapegoatTree(double alpha = 0.5);
-    explicit ScapegoatTree(std::vector<T> values, double alpha = 0.5);
-    iterator insert(const T &value) override;
+    using iterator = typename ScapegoatTree<T, Allocator>::iterator;
+    explicit ScapegoatTree(double alpha = 0.5, const Allocator &allocator = Allocator());
+    explicit ScapegoatTree(std::vector<T> values, double alpha = 0.5, const Allocator &allocator = Allocator());
+    std::pair<iterator, bool> insert(const T &value) override;
+    iterator insert(iterator hint, const T &value) override;
     void remove(const T &value) override;
+    iterator find(const T &value) override;
+    void enable_adaptive_alpha(const AlphaTuning &tuning = AlphaTuning());
+    void disable_adaptive_alpha();
+    [[nodiscard]] double get_alpha() const;
+    [[nodiscard]] const AlphaChange &last_alpha_change() const;
+    void enable_lazy_deletion(double max_dead_fraction = .5);
+    void disable_lazy_deletion();
+    // Rebuilds of at least min_size nodes flatten and relink subtrees on several threads. The shape of the result
+    // does not depend on the thread count.
+    void enable_parallel_rebuild(size_t min_size = 1 << 16, size_t threads = std::thread::hardware_concurrency());
+    void disable_parallel_rebuild();
+    // Counts every sample_period-th successful find() on the node it lands on. rebuild_by_weight() then lays the
+    // tree, or the subtree under one element, out by Mehlhorn's bisection rule on count + 1 in O(n): hot keys move
+    // towards the root while the order is unchanged. A whole-tree rebuild also stores the nodes breadth first, so the
+    // hot top levels share cache lines; it invalidates iterators. The next rebuild an update triggers balances its
+    // subtree again.
+    void enable_access_counting(size_t sample_period = 1);
+    void disable_access_counting();
+    void rebuild_by_weight();
+    void rebuild_by_weight(iterator subtree);
+    // Rebuilds of min_size nodes or more stop running inside the insert() or remove() that needs them. The whole
+    // tree is rebuilt instead into a shadow copy, which every later insert(), remove() and find() advances by `step`
+    // values after one O(log n) seek; updates behind the copy's position are queued and replayed into it two per
+    // operation. Until the copy has caught up the tree answers from its old nodes, and big scapegoats found meanwhile
+    // are left to the copy; every level an insert lands past the height limit doubles the work per operation, so
+    // the old nodes stay within about log2(n / (step * min_size)) levels of it. The swap is O(1) and happens in
+    // insert() or remove(), so find() keeps iterators valid.
+    // Multisets, augmented trees and access counting keep synchronous rebuilds.
+    void enable_incremental_rebuild(size_t min_size = 1 << 12, size_t step = 8);
+    void disable_incremental_rebuild();     // drops a running copy and rebuilds synchronously
+    [[nodiscard]] bool is_rebuilding() const;
+
+protected:
+    void swap_nodes(size_t first, size_t second) override;
 
 private:
-    using Node = typename BinarySearchTree<T>::Node;
-    using restricted_iterator = typename BinarySearchTree<T>::restricted_iterator;
+    using Node = typename BinarySearchTree<T, Allocator>::Node;
+    using restricted_iterator = typename BinarySearchTree<T, Allocator>::restricted_iterator;
+    using InsertPosition = typename BinarySearchTree<T, Allocator>::InsertPosition;
+    template <typename U>
+    using vector = typename BinarySearchTree<T, Allocator>::template vector<U>;
+    template <typename U>
+    using stack = typename BinarySearchTree<T, Allocator>::template stack<U>;
     double alpha;
     size_t max_node_count = 0;
+    bool adaptive_alpha = false;
+    AlphaTuning tuning;
+    AlphaChange alpha_change;
+    struct WindowSlice {
+        size_t reads = 0;
+        size_t writes = 0;
+        size_t rebuilt_nodes = 0;
+    };
+    static constexpr size_t window_slices = 8;
+    std::array<WindowSlice, window_slices> window{};     // ring of window / window_slices operations each
+    size_t current_slice = 0;
+    bool lazy_deletion = false;
+    double max_dead_fraction = .5;
+    size_t height_limit = 0;
+    size_t height_limit_min_size = 0;
+    size_t height_limit_max_size = 0;
+    size_t parallel_rebuild_min_size = 0;
+    size_t rebuild_threads = 1;
+    size_t access_sample_period = 0;
+    size_t access_clock = 0;
+    vector<uint32_t> access_counts;     // by node index, sampled hits since counting was enabled
+    size_t incremental_min_size = 0;
+    size_t incremental_step = 8;
+    bool is_shadow = false;             // the copy of an incremental rebuild, which never starts one itself
+    // The values are streamed in order into the shadow as a stack of subtrees, like a binary counter: a complete
+    // subtree waits for the next value as its parent, which then waits for a right subtree of the same height.
+    struct SpineEntry {
+        size_t index;
+        size_t height;          // of the subtree, or of the left one for a parent still missing its right subtree
+        bool complete;
+    };
+    struct RebuildJob {
+        std::unique_ptr<ScapegoatTree> shadow;      // null while no rebuild runs
+        bool streaming = false;                     // still copying; replaying the queue afterwards
+        std::optional<T> cursor;                    // last value the copy passed, dead or alive
+        vector<SpineEntry> spine;
+        vector<std::pair<T, bool>> pending;         // updates the shadow has not seen, true for inserts
+        size_t pending_head = 0;
+        size_t excess = 0;                          // most levels an insert landed past the height limit meanwhile
+
+        RebuildJob() = default;
+        RebuildJob(const RebuildJob &other);
+        RebuildJob(RebuildJob &&other) noexcept = default;
+        RebuildJob &operator=(const RebuildJob &other);
+        RebuildJob &operator=(RebuildJob &&other) noexcept = default;
+    };
+    RebuildJob rebuild_job;
 private:
     inline bool is_height_balanced(size_t height);
-    size_t insert_value(const T &value);
-    Node &find_scapegoat();
-    Node &find_min_in_subtree(Node &root);
-    Node &find_max_in_subtree(Node &root);
-    void rebuild_subtree(Node &root);
+    void update_height_limit();
+    void record_operation(bool write);
+    void tune_alpha();
+    InsertPosition descend(const T &value, size_t &height);
+    std::pair<iterator, bool> insert_at(InsertPosition position, const T &value, size_t height);
+    void rebuild_tree();
+    Node *find_scapegoat(size_t &subtree_size, size_t size_limit = SIZE_MAX);
+    size_t rebuild_subtree(Node &root, size_t subtree_size, size_t tracked_index = 0);
+    void flatten(size_t index, vector<size_t> &live_nodes, vector<size_t> &dead_nodes) const;
+    size_t link_balanced(const vector<size_t> &nodes, size_t left, size_t right, size_t parent_index);
+    size_t release_dead(vector<size_t> &dead_nodes, size_t tracked_index);
+    void relayout_by_weight(Node &root);
+    size_t link_weighted(const vector<size_t> &nodes, const vector<uint64_t> &prefix, size_t left, size_t right,
+                         size_t parent_index);
+    [[nodiscard]] bool rebuilds_incrementally() const;
+    void request_rebuild();
+    void start_rebuild();
+    bool advance_rebuild(bool may_swap);    // true once the copy has replaced the nodes
+    void stream_value(const T &value);
+    void finish_stream();
+    void record_update(const T &value, bool inserted);
 };
 
-template <typename T>
-ScapegoatTree<T>::ScapegoatTree(std::vector<T> values, double alpha) {
-    if(alpha > 1) this->alpha = 1;
-    else if(alpha < .5) this->alpha = .5;
-    else this->alpha = alpha;
+template <typename T, typename Allocator>
+ScapegoatTree<T, Allocator>::ScapegoatTree(std::vector<T> values, double alpha, const Allocator &allocator)
+        : ScapegoatTree(alpha, allocator) {
     for(auto value : values) {
         this->insert(value);
     }
 }
 
-template <typename T>
-ScapegoatTree<T>::ScapegoatTree(double alpha) {
+template <typename T, typename Allocator>
+ScapegoatTree<T, Allocator>::ScapegoatTree(double alpha, const Allocator &allocator)
+        : BinarySearchTree<T, Allocator>(allocator), access_counts(allocator) {
     if(alpha > 1) this->alpha = 1;
     else if(alpha < .5) this->alpha = .5;
     else this->alpha = alpha;
 }
 
-template <typename T>
-ScapegoatTree<T>::iterator ScapegoatTree<T>::insert(const T &value) {
-    if(this->empty()) {
-        this->emplace(value);
-        return this->begin();
+template <typename T, typename Allocator>
+std::pair<typename ScapegoatTree<T, Allocator>::iterator, bool> ScapegoatTree<T, Allocator>::insert(const T &value) {
+    if(this->adaptive_alpha) this->record_operation(true);
+    if(this->rebuild_job.shadow) this->advance_rebuild(true);
+    size_t height = 0;
+    InsertPosition position = this->descend(value, height);
+    return this->insert_at(position, value, height);
+}
+
+template <typename T, typename Allocator>
+ScapegoatTree<T, Allocator>::iterator ScapegoatTree<T, Allocator>::insert(iterator hint, const T &value) {
+    if(this->adaptive_alpha) this->record_operation(true);
+    if(this->rebuild_job.shadow && this->advance_rebuild(true)) hint = this->end();  // the hint's node is gone
+    InsertPosition position = this->find_insert_position(hint, value);
+    size_t height = 0;
+    // The depth check needs the new node's depth, which no hint carries, so a hinted insert still climbs O(log n)
+    // parent links; it only saves the key comparisons of a descent.
+    if(!position.exists) {
+        for(Node *node = position.node; !node->is_end_node(); node = &node->parent()) height++;
+    }
+    return this->insert_at(position, value, height).first;
+}
+
+template <typename T, typename Allocator>
+std::pair<typename ScapegoatTree<T, Allocator>::iterator, bool>
+ScapegoatTree<T, Allocator>::insert_at(InsertPosition position, const T &value, size_t height) {
+    if(position.exists) {
+        if(!position.node->is_dead()) return {iterator(*position.node), false};
+        this->filter_insert(value);
+        position.node->set_dead(false);
+        this->dead_count--;
+        this->update_path(*position.node);
+        this->record_update(value, true);
+        return {iterator(*position.node), true};
+    }
+
+    Node &node = this->attach(*position.node, position.left, value);
+    if(node.get_node_index() < this->access_counts.size()) this->access_counts[node.get_node_index()] = 0;
+    this->update_path(node);
+    this->record_update(value, true);
+    this->max_node_count = std::max(this->max_node_count, this->node_count());
+    if(this->is_height_balanced(height)) return {iterator(this->back()), true};
+
+    size_t subtree_size = 0;
+    bool incremental = this->rebuilds_incrementally();
+    Node *scapegoat = this->find_scapegoat(subtree_size, incremental ? this->incremental_min_size : SIZE_MAX);
+    if(scapegoat == nullptr) {
+        RebuildJob &job = this->rebuild_job;
+        if(job.shadow) job.excess = std::max(job.excess, height - this->height_limit);
+        else if(incremental && !this->is_shadow) this->start_rebuild();
+        return {iterator(this->back()), true};
+    }
+    size_t index = this->rebuild_subtree(*scapegoat, subtree_size, this->back().get_node_index());
+    return {iterator(this->at(index)), true};
+}
+
+template <typename T, typename Allocator>
+ScapegoatTree<T, Allocator>::iterator ScapegoatTree<T, Allocator>::find(const T &value) {
+    if(this->adaptive_alpha) this->record_operation(false);
+    if(this->rebuild_job.shadow) this->advance_rebuild(false);
+    iterator it = BinarySearchTree<T, Allocator>::find(value);
+    if(this->access_sample_period == 0 || it == this->end()) return it;
+    if(++this->access_clock % this->access_sample_period == 0) {
+        size_t index = this->node_of(it).get_node_index();
+        if(this->access_counts.size() <= index) this->access_counts.resize(this->node_count() + 1, 0);
+        if(this->access_counts[index] < std::numeric_limits<uint32_t>::max()) this->access_counts[index]++;
+    }
+    return it;
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::enable_access_counting(size_t sample_period) {
+    this->access_sample_period = std::max<size_t>(sample_period, 1);
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::disable_access_counting() {
+    this->access_sample_period = 0;
+    this->access_clock = 0;
+    this->access_counts.clear();
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::swap_nodes(size_t first, size_t second) {
+    if(this->access_counts.empty()) return;
+    size_t last = std::max(first, second);
+    if(this->access_counts.size() <= last) this->access_counts.resize(std::max(last, this->node_count()) + 1, 0);
+    std::swap(this->access_counts[first], this->access_counts[second]);
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::enable_lazy_deletion(double max_dead_fraction) {
+    this->lazy_deletion = true;
+    this->max_dead_fraction = std::clamp(max_dead_fraction, 0., 1.);
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::disable_lazy_deletion() {
+    this->lazy_deletion = false;
+    if(this->dead_count > 0) this->rebuild_tree();
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::enable_adaptive_alpha(const AlphaTuning &tuning) {
+    this->tuning = tuning;
+    this->tuning.min_alpha = std::clamp(tuning.min_alpha, .5, 1.);
+    this->tuning.max_alpha = std::clamp(tuning.max_alpha, this->tuning.min_alpha, 1.);
+    this->tuning.window = std::max<size_t>(tuning.window, 1);
+    this->adaptive_alpha = true;
+    this->window.fill({});
+    this->current_slice = 0;
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::disable_adaptive_alpha() {
+    this->adaptive_alpha = false;
+}
+
+template <typename T, typename Allocator>
+double ScapegoatTree<T, Allocator>::get_alpha() const {
+    return this->alpha;
+}
+
+template <typename T, typename Allocator>
+const AlphaChange &ScapegoatTree<T, Allocator>::last_alpha_change() const {
+    return this->alpha_change;
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::record_operation(bool write) {
+    WindowSlice &slice = this->window[this->current_slice];
+    if(write) slice.writes++;
+    else slice.reads++;
+    if(slice.reads + slice.writes >= std::max<size_t>(this->tuning.window / window_slices, 1)) this->tune_alpha();
+}
+
+// Runs whenever a slice fills, over the operations of the last window_slices slices. Expensive rebuilds loosen the
+// balance first; otherwise alpha drifts one step at a time towards a target that sits at max_alpha for pure writes
+// and at min_alpha for pure reads.
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::tune_alpha() {
+    size_t reads = 0, writes = 0, rebuilt_nodes = 0;
+    for(const WindowSlice &slice : this->window) {
+        reads += slice.reads;
+        writes += slice.writes;
+        rebuilt_nodes += slice.rebuilt_nodes;
+    }
+    double previous_alpha = this->alpha;
+    double read_fraction = static_cast<double>(reads) / (reads + writes);
+    double target = this->tuning.max_alpha - (this->tuning.max_alpha - this->tuning.min_alpha) * read_fraction;
+    AlphaChangeReason reason = AlphaChangeReason::none;
+
+    if(rebuilt_nodes > this->tuning.rebuild_budget * writes) {
+        this->alpha += this->tuning.step;
+        reason = AlphaChangeReason::rebuild_cost;
+    }
+    else if(this->alpha > target + this->tuning.step / 2) {
+        this->alpha -= this->tuning.step;
+        reason = AlphaChangeReason::read_heavy;
+    }
+    else if(this->alpha < target - this->tuning.step / 2) {
+        this->alpha += this->tuning.step;
+        reason = AlphaChangeReason::write_heavy;
+    }
+    this->alpha = std::clamp(this->alpha, this->tuning.min_alpha, this->tuning.max_alpha);
+
+    if(this->alpha != previous_alpha) {
+        this->alpha_change = {previous_alpha, this->alpha, reason, reads, writes, rebuilt_nodes};
+        // A higher alpha would make remove() see the tree as shrunk and rebuild it all; restart the count instead.
+        this->max_node_count = std::min(this->max_node_count, this->node_count());
+        this->height_limit_min_size = this->height_limit_max_size = 0;
+        // Rebuilds counted under the old alpha say nothing about the new one.
+        for(WindowSlice &slice : this->window) slice.rebuilt_nodes = 0;
+    }
+    this->current_slice = (this->current_slice + 1) % window_slices;
+    this->window[this->current_slice] = {};
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::enable_parallel_rebuild(size_t min_size, size_t threads) {
+    this->parallel_rebuild_min_size = std::max<size_t>(min_size, 1);
+    this->rebuild_threads = std::max<size_t>(threads, 1);
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::disable_parallel_rebuild() {
+    this->parallel_rebuild_min_size = 0;
+    this->rebuild_threads = 1;
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::enable_incremental_rebuild(size_t min_size, size_t step) {
+    this->incremental_min_size = std::max<size_t>(min_size, 1);
+    this->incremental_step = std::max<size_t>(step, 2);     // the copy has to outrun a stream of appends
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::disable_incremental_rebuild() {
+    this->incremental_min_size = 0;
+    if(!this->rebuild_job.shadow) return;
+    this->rebuild_job = RebuildJob();
+    this->rebuild_tree();
+}
+
+template <typename T, typename Allocator>
+bool ScapegoatTree<T, Allocator>::is_rebuilding() const {
+    return this->rebuild_job.shadow != nullptr;
+}
+
+template <typename T, typename Allocator>
+bool ScapegoatTree<T, Allocator>::rebuilds_incrementally() const {
+    return this->incremental_min_size > 0 && !this->multiset && !this->augmented && this->access_sample_period == 0;
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::request_rebuild() {
+    if(!this->rebuilds_incrementally() || this->is_shadow || this->node_count() < this->incremental_min_size) {
+        this->rebuild_tree();
+    }
+    else if(!this->rebuild_job.shadow) this->start_rebuild();
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::start_rebuild() {
+    RebuildJob &job = this->rebuild_job;
+    job = RebuildJob();
+    job.shadow = std::make_unique<ScapegoatTree>(this->alpha, this->get_allocator());
+    job.shadow->is_shadow = true;
+    job.shadow->incremental_min_size = this->incremental_min_size;
+    // Streaming takes at least size() / step operations and the replay at most as many again, each adding one value
+    // at most; growing the vector inside one step would copy every node the shadow holds.
+    job.shadow->reserve_nodes(this->size() + 2 * (this->size() / this->incremental_step + 1));
+    job.streaming = true;
+    job.spine = vector<SpineEntry>(this->get_allocator());
+    job.pending = vector<std::pair<T, bool>>(this->get_allocator());
+}
+
+// The copy seeks past its cursor by value, so whatever happened to the old nodes since the last step is harmless.
+template <typename T, typename Allocator>
+bool ScapegoatTree<T, Allocator>::advance_rebuild(bool may_swap) {
+    RebuildJob &job = this->rebuild_job;
+    size_t boost = size_t(1) << std::min<size_t>(job.excess, 32);
+    if(job.streaming) {
+        Node *first = &this->at(0);
+        while(!job.cursor && first->has_left()) first = &first->left();
+        restricted_iterator it = job.cursor ? this->find_lower_bound(*job.cursor) : restricted_iterator(*first);
+        if(job.cursor && !it.get_node().is_end_node() && !(*job.cursor < *it)) ++it;
+        size_t steps = 0;
+        for(; steps < boost * this->incremental_step && !it.get_node().is_end_node(); ++it, steps++) {
+            if(!it.get_node().is_dead()) this->stream_value(*it);
+            job.cursor = *it;
+        }
+        this->window[this->current_slice].rebuilt_nodes += steps;
+        if(it.get_node().is_end_node()) this->finish_stream();
+        return false;
+    }
+
+    ScapegoatTree &shadow = *job.shadow;
+    shadow.alpha = this->alpha;
+    for(size_t replayed = 0; replayed < 2 * boost && job.pending_head < job.pending.size(); replayed++) {
+        const auto &[value, inserted] = job.pending[job.pending_head++];
+        if(inserted) shadow.insert(value);
+        else shadow.BinarySearchTree<T, Allocator>::remove(value);
+    }
+    if(!may_swap || job.pending_head < job.pending.size()) return false;
+
+    this->exchange_nodes(shadow);
+    this->max_node_count = this->node_count();
+    this->height_limit_min_size = this->height_limit_max_size = 0;
+    this->access_counts.clear();
+    this->rebuild_job = RebuildJob();
+    return true;
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::stream_value(const T &value) {
+    ScapegoatTree &shadow = *this->rebuild_job.shadow;
+    vector<SpineEntry> &spine = this->rebuild_job.spine;
+    size_t index = shadow.next_index();
+    shadow.emplace(value);
+    if(!spine.empty() && spine.back().complete) {
+        SpineEntry left = spine.back();
+        spine.pop_back();
+        shadow.at(index).set_left_index(left.index);
+        shadow.at(left.index).set_parent_index(index);
+        spine.push_back({index, left.height, false});
+        return;
+    }
+    size_t root = index, height = 1;
+    while(!spine.empty() && spine.back().height == height) {
+        size_t parent = spine.back().index;
+        spine.pop_back();
+        shadow.at(parent).set_right_index(root);
+        shadow.at(root).set_parent_index(parent);
+        root = parent;
+        height++;
+    }
+    spine.push_back({root, height, true});
+}
+
+// Parents still missing a right subtree take what follows them on the stack, which keeps the height at
+// ceil(log2(n + 1)).
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::finish_stream() {
+    ScapegoatTree &shadow = *this->rebuild_job.shadow;
+    vector<SpineEntry> &spine = this->rebuild_job.spine;
+    size_t root = 0;
+    if(!spine.empty() && spine.back().complete) {
+        root = spine.back().index;
+        spine.pop_back();
     }
+    for(; !spine.empty(); spine.pop_back()) {
+        size_t parent = spine.back().index;
+        shadow.at(parent).set_right_index(root);
+        if(root != 0) shadow.at(root).set_parent_index(parent);
+        root = parent;
+    }
+    shadow.at(0).set_left_index(root);
+    if(root != 0) shadow.at(root).set_parent_index(0);
+    shadow.refresh_extremes();
+    shadow.max_node_count = shadow.node_count();
+    this->rebuild_job.streaming = false;
+}
 
-    size_t height = this->insert_value(value);
-    if(this->is_height_balanced(height)) return iterator(this->back());
+// Values the copy has not reached yet need no queueing, it will read their current state.
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::record_update(const T &value, bool inserted) {
+    RebuildJob &job = this->rebuild_job;
+    if(!job.shadow) return;
+    if(job.streaming && (!job.cursor || *job.cursor < value)) return;
+    job.pending.emplace_back(value, inserted);
+}
+
+template <typename T, typename Allocator>
+ScapegoatTree<T, Allocator>::RebuildJob::RebuildJob(const RebuildJob &other)
+        : shadow(other.shadow ? std::make_unique<ScapegoatTree>(*other.shadow) : nullptr),
+          streaming(other.streaming),
+          cursor(other.cursor),
+          spine(other.spine),
+          pending(other.pending),
+          pending_head(other.pending_head),
+          excess(other.excess) {}
 
-    this->rebuild_subtree(this->find_scapegoat());
-    this->max_node_count = std::max(this->max_node_count, this->size());
-    return this->find(value);
+template <typename T, typename Allocator>
+typename ScapegoatTree<T, Allocator>::RebuildJob &
+ScapegoatTree<T, Allocator>::RebuildJob::operator=(const RebuildJob &other) {
+    if(this != &other) *this = RebuildJob(other);
+    return *this;
 }
 
-template <typename T>
-void ScapegoatTree<T>::rebuild_subtree(Node &root) {
-    Node &root_parent = root.parent();
+// Nodes keep their values and are only relinked: the node at the middle of each range becomes its root. Every
+// live index therefore survives, and tracked_index only moves when popping the dead nodes shifts it.
+template <typename T, typename Allocator>
+size_t ScapegoatTree<T, Allocator>::rebuild_subtree(Node &root, size_t subtree_size, size_t tracked_index) {
+    size_t root_parent_index = root.get_parent_index();
     bool is_root_left_sibling = root.is_left_sibling();
+    bool parallel = this->parallel_rebuild_min_size > 0 && subtree_size >= this->parallel_rebuild_min_size &&
+                    this->rebuild_threads > 1;
+    size_t depth = 0;
+    if(parallel) {
+        while((size_t(1) << depth) < 4 * this->rebuild_threads) depth++;
+    }
 
-    std::vector<Node *> sorted_nodes;
-    std::vector<T> sorted_values;
+    vector<size_t> sorted_nodes(this->get_allocator());
+    vector<size_t> dead_nodes(this->get_allocator());
+    if(!parallel) {
+        sorted_nodes.reserve(subtree_size);
+        this->flatten(root.get_node_index(), sorted_nodes, dead_nodes);
+    }
+    else {
+        // The top levels are peeled in order; whatever hangs below them is flattened as one task each.
+        struct Segment {
+            size_t index;
+            bool whole_subtree;
+        };
+        vector<Segment> segments(this->get_allocator());
+        auto peel = [this, &segments](auto &self, size_t index, size_t levels) -> void {
+            if(index == 0) return;
+            if(levels == 0) {
+                segments.push_back({index, true});
+                return;
+            }
+            self(self, this->at(index).get_left_index(), levels - 1);
+            segments.push_back({index, false});
+            self(self, this->at(index).get_right_index(), levels - 1);
+        };
+        peel(peel, root.get_node_index(), depth);
 
-    auto begin = restricted_iterator(this->find_min_in_subtree(root));
-    auto end = restricted_iterator(this->find_max_in_subtree(root)) + 1;
-    for(auto it = begin; it != end; it++) {
-        sorted_nodes.push_back(&it.get_node());
-        sorted_values.push_back(*it);
+        std::vector<vector<size_t>> live_parts(segments.size(), vector<size_t>(this->get_allocator()));
+        std::vector<vector<size_t>> dead_parts(segments.size(), vector<size_t>(this->get_allocator()));
+        this->parallel_run(segments.size(), this->rebuild_threads, [&](size_t i) {
+            if(segments[i].whole_subtree) this->flatten(segments[i].index, live_parts[i], dead_parts[i]);
+            else if(this->at(segments[i].index).is_dead()) dead_parts[i].push_back(segments[i].index);
+            else live_parts[i].push_back(segments[i].index);
+        });
+        std::vector<size_t> offsets(segments.size() + 1, 0);
+        for(size_t i = 0; i < segments.size(); i++) offsets[i + 1] = offsets[i] + live_parts[i].size();
+        sorted_nodes.resize(offsets.back());
+        this->parallel_run(segments.size(), this->rebuild_threads, [&](size_t i) {
+            std::copy(live_parts[i].begin(), live_parts[i].end(), sorted_nodes.begin() + offsets[i]);
+        });
+        for(auto &part : dead_parts) dead_nodes.insert(dead_nodes.end(), part.begin(), part.end());
     }
+    this->window[this->current_slice].rebuilt_nodes += sorted_nodes.size() + dead_nodes.size();
 
-    std::stack<std::tuple<size_t, size_t, size_t, bool>> s; // left, right, parent_index, is_left_sibling
-    s.push(std::make_tuple(0, sorted_nodes.size() - 1, root_parent.get_node_index(), is_root_left_sibling));
-    size_t index = 0;
-    while(!s.empty()) {
-        std::tuple<size_t, size_t, size_t, bool> top = s.top();
-        s.pop();
+    // The top levels are linked here; each range below them is linked by one task, which hooks its root back in.
+    struct Range {
+        size_t left;
+        size_t right;
+        size_t parent_index;
+        bool is_left_sibling;
+    };
+    vector<Range> ranges(this->get_allocator());
+    vector<size_t> top_nodes(this->get_allocator());
+    auto split = [&](auto &self, size_t left, size_t right, size_t parent_index, bool is_left_sibling,
+                     size_t levels) -> void {
+        if(levels == 0 || left == right) {
+            ranges.push_back({left, right, parent_index, is_left_sibling});
+            return;
+        }
+        size_t mid = left + (right - left - 1) / 2;
+        Node &node = this->at(sorted_nodes[mid]);
+        node.set_parent_index(parent_index);
+        if(is_left_sibling) this->at(parent_index).set_left_index(node.get_node_index());
+        else this->at(parent_index).set_right_index(node.get_node_index());
+        top_nodes.push_back(node.get_node_index());
+        self(self, left, mid, node.get_node_index(), true, levels - 1);
+        self(self, mid + 1, right, node.get_node_index(), false, levels - 1);
+    };
+    split(split, 0, sorted_nodes.size(), root_parent_index, is_root_left_sibling, depth);
+    this->parallel_run(ranges.size(), parallel ? this->rebuild_threads : 1, [&](size_t i) {
+        const Range &range = ranges[i];
+        size_t child = this->link_balanced(sorted_nodes, range.left, range.right, range.parent_index);
+        if(range.is_left_sibling) this->at(range.parent_index).set_left_index(child);
+        else this->at(range.parent_index).set_right_index(child);
+    });
+    if(this->augmented) {
+        for(size_t i = top_nodes.size(); i-- > 0;) this->update_node(this->at(top_nodes[i]));
+    }
 
-        size_t left_index = std::get<0>(top);
-        size_t right_index = std::get<1>(top);
-        size_t parent_index = std::get<2>(top);
-        bool is_left_sibling = std::get<3>(top);
+    return this->release_dead(dead_nodes, tracked_index);
+}
 
-        if(left_index > right_index) continue;
-        size_t mid = (left_index + right_index) / 2;
+// Dead nodes are detached by now; popping from the highest index down only ever moves live nodes.
+template <typename T, typename Allocator>
+size_t ScapegoatTree<T, Allocator>::release_dead(vector<size_t> &dead_nodes, size_t tracked_index) {
+    std::sort(dead_nodes.begin(), dead_nodes.end(), std::greater<>());
+    for(size_t dead_index : dead_nodes) {
+        size_t back_index = this->node_count();
+        this->pop(dead_index);
+        if(tracked_index == back_index) tracked_index = dead_index;
+    }
+    this->dead_count -= dead_nodes.size();
+    if(!dead_nodes.empty()) this->refresh_extremes();
+    return tracked_index;
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::rebuild_by_weight() {
+    if(this->empty()) return;
+    this->relayout_by_weight(this->root());
+    this->max_node_count = this->node_count();
+
+    vector<size_t> order(this->get_allocator());
+    order.reserve(this->node_count());
+    order.push_back(this->root().get_node_index());
+    for(size_t i = 0; i < order.size(); i++) {
+        const Node &node = this->at(order[i]);
+        if(node.has_left()) order.push_back(node.get_left_index());
+        if(node.has_right()) order.push_back(node.get_right_index());
+    }
+    if(!this->access_counts.empty()) this->access_counts.resize(this->node_count() + 1, 0);
+    this->relocate(order);
+}
 
-        Node &new_root = *sorted_nodes.at(index);
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::rebuild_by_weight(iterator subtree) {
+    Node &root = this->node_of(subtree);
+    if(root.is_end_node()) this->rebuild_by_weight();
+    else this->relayout_by_weight(root);
+}
 
-        new_root.set_value(sorted_values.at(mid));
-        new_root.set_parent_index(parent_index);
-        new_root.set_right_index(0);
-        new_root.set_left_index(0);
-        if(is_left_sibling) new_root.parent().set_left_index(new_root.get_node_index());
-        else new_root.parent().set_right_index(new_root.get_node_index());
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::relayout_by_weight(Node &root) {
+    size_t root_parent_index = root.get_parent_index();
+    bool is_root_left_sibling = root.is_left_sibling();
+    vector<size_t> sorted_nodes(this->get_allocator());
+    vector<size_t> dead_nodes(this->get_allocator());
+    this->flatten(root.get_node_index(), sorted_nodes, dead_nodes);
+    this->window[this->current_slice].rebuilt_nodes += sorted_nodes.size() + dead_nodes.size();
 
-        s.push(std::make_tuple(mid + 1, right_index, new_root.get_node_index(), false));
-        if(mid > 0) s.push(std::make_tuple(left_index, mid - 1, new_root.get_node_index(), true));
-        index++;
+    vector<uint64_t> prefix(sorted_nodes.size() + 1, 0, this->get_allocator());
+    for(size_t i = 0; i < sorted_nodes.size(); i++) {
+        uint64_t count = sorted_nodes[i] < this->access_counts.size() ? this->access_counts[sorted_nodes[i]] : 0;
+        prefix[i + 1] = prefix[i] + count + 1;
     }
+    size_t child = this->link_weighted(sorted_nodes, prefix, 0, sorted_nodes.size(), root_parent_index);
+    if(is_root_left_sibling) this->at(root_parent_index).set_left_index(child);
+    else this->at(root_parent_index).set_right_index(child);
+    this->release_dead(dead_nodes, 0);
 }
 
+// The root of nodes[left, right) is the node whose weight straddles the middle of the range. Probing from both
+// ends at once finds it in O(log min(k - left, right - k)) steps, which sums to O(n) over the whole recursion.
+template <typename T, typename Allocator>
+size_t ScapegoatTree<T, Allocator>::link_weighted(const vector<size_t> &nodes, const vector<uint64_t> &prefix,
+                                                  size_t left, size_t right, size_t parent_index) {
+    if(left == right) return 0;
+    uint64_t middle = prefix[left] + (prefix[right] - prefix[left]) / 2;
+    auto reaches = [&prefix, middle](size_t k) { return prefix[k + 1] > middle; };
+    size_t low = left, high = right - 1;    // the root is the first k in [low, high] that reaches the middle
+    for(size_t step = 1; low < high; step *= 2) {
+        size_t probe = left + step - 1;
+        if(probe >= high) break;
+        if(reaches(probe)) {
+            high = probe;
+            break;
+        }
+        low = probe + 1;
+        if(right - 1 - step < low) break;
+        probe = right - 1 - step;
+        if(!reaches(probe)) {
+            low = probe + 1;
+            break;
+        }
+        high = probe;
+    }
+    while(low < high) {
+        size_t mid = low + (high - low) / 2;
+        if(reaches(mid)) high = mid;
+        else low = mid + 1;
+    }
 
-template <typename T>
-typename ScapegoatTree<T>::Node &ScapegoatTree<T>::find_min_in_subtree(Node &root) {
-    Node *node = &root;
-    while(node->has_left()) node = &node->left();
-    return *node;
+    Node &node = this->at(nodes[low]);
+    node.set_parent_index(parent_index);
+    node.set_left_index(this->link_weighted(nodes, prefix, left, low, node.get_node_index()));
+    node.set_right_index(this->link_weighted(nodes, prefix, low + 1, right, node.get_node_index()));
+    if(this->augmented) this->update_node(node);
+    return node.get_node_index();
+}
+
+// In-order indices of the subtree at index, split into live and dead nodes.
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::flatten(size_t index, vector<size_t> &live_nodes, vector<size_t> &dead_nodes) const {
+    vector<size_t> path(this->get_allocator());
+    while(index != 0 || !path.empty()) {
+        while(index != 0) {
+            path.push_back(index);
+            index = this->at(index).get_left_index();
+        }
+        const Node &node = this->at(path.back());
+        path.pop_back();
+        if(node.is_dead()) dead_nodes.push_back(node.get_node_index());
+        else live_nodes.push_back(node.get_node_index());
+        index = node.get_right_index();
+    }
 }
 
-template <typename T>
-typename ScapegoatTree<T>::Node &ScapegoatTree<T>::find_max_in_subtree(Node &root) {
-    Node *node = &root;
-    while(node->has_right()) node = &node->right();
-    return *node;
+// Links nodes[left, right) into a perfectly balanced subtree under parent_index and returns its root, 0 if empty.
+template <typename T, typename Allocator>
+size_t ScapegoatTree<T, Allocator>::link_balanced(const vector<size_t> &nodes, size_t left, size_t right,
+                                                  size_t parent_index) {
+    if(left == right) return 0;
+    size_t mid = left + (right - left - 1) / 2;
+    Node &node = this->at(nodes[mid]);
+    node.set_parent_index(parent_index);
+    node.set_left_index(this->link_balanced(nodes, left, mid, node.get_node_index()));
+    node.set_right_index(this->link_balanced(nodes, mid + 1, right, node.get_node_index()));
+    if(this->augmented) this->update_node(node);
+    return node.get_node_index();
 }
 
-template <typename T>
-size_t ScapegoatTree<T>::insert_value(const T &value) {
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::rebuild_tree() {
+    if(!this->empty()) this->rebuild_subtree(this->root(), this->node_count());
+    this->max_node_count = this->node_count();
+}
+
+
+template <typename T, typename Allocator>
+typename ScapegoatTree<T, Allocator>::InsertPosition ScapegoatTree<T, Allocator>::descend(const T &value, size_t &height) {
+    if(this->empty()) return {&this->at(0), true, false};
+
     Node *node = &this->root();
-    size_t height = 0;
 
     while(true) {
         height++;
         if(value < node->get_value()) {
-            if(!node->has_left()) {
-                node->set_left_index(this->next_index());
-                this->emplace(value, node->get_node_index());
-                break;
-            }
+            if(!node->has_left()) return {node, true, false};
             node = &node->left();
         }
-        else if(value > node->get_value()) {
-            if(!node->has_right()) {
-                node->set_right_index(this->next_index());
-                this->emplace(value, node->get_node_index());
-                break;
-            }
+        else if(this->multiset || value > node->get_value()) {
+            if(!node->has_right()) return {node, false, false};
             node = &node->right();
         }
-        else throw DuplicateElement();
+        else return {node, false, true};
     }
-
-    return height;
 }
 
-template <typename T>
-typename ScapegoatTree<T>::Node &ScapegoatTree<T>::find_scapegoat() {
+// Gives up with nullptr once the subtrees it weighs grow past size_limit.
+template <typename T, typename Allocator>
+typename ScapegoatTree<T, Allocator>::Node *ScapegoatTree<T, Allocator>::find_scapegoat(size_t &subtree_size,
+                                                                                       size_t size_limit) {
     size_t child_size = 1;
     Node *child = &this->back();
     Node *node = &child->parent();
     while(true) {
         size_t node_size = child_size + 1;
         size_t sibling_size = 0;
-        if(child->has_sibling()) sibling_size = this->size(child->sibling());
+        if(child->has_sibling()) sibling_size = this->size(child->sibling().get_node_index(), size_limit);
         node_size += sibling_size;
+        if(node_size > size_limit || node->is_end_node()) return nullptr;
 
         if(child_size > this->alpha * node_size || sibling_size > this->alpha * node_size) {
-            return *node;
+            subtree_size = node_size;
+            return node;
         }
         child = node;
         child_size = node_size;
@@ -170,22 +802,60 @@ typename ScapegoatTree<T>::Node &ScapegoatTree<T>::find_scapegoat() {
     }
 }
 
-template <typename T>
-inline bool ScapegoatTree<T>::is_height_balanced(size_t height) {
-    size_t tree_size = this->size();
-    double log_one_over_alpha = std::log(tree_size) / std::log(1 / this->alpha);
-    int result = static_cast<int>(std::floor(log_one_over_alpha)) + 1;
-    return height <= result;
+// floor(log_{1/alpha}(n)) + 1 only changes when n crosses a power of 1/alpha, so the logarithm is taken once per
+// crossing instead of on every insert.
+template <typename T, typename Allocator>
+inline bool ScapegoatTree<T, Allocator>::is_height_balanced(size_t height) {
+    size_t tree_size = this->node_count();
+    if(tree_size < this->height_limit_min_size || tree_size >= this->height_limit_max_size) this->update_height_limit();
+    return height <= this->height_limit;
 }
 
-template <typename T>
-void ScapegoatTree<T>::remove(const T &value) {
-    BinarySearchTree<T>::remove(value);
-    if(this->size() <= this->alpha * this->max_node_count && this->size() > 0) {
-        this->rebuild_subtree(this->root());
-        this->rebuild_subtree(this->root());
-        this->max_node_count = this->size();
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::update_height_limit() {
+    if(this->alpha >= 1) {
+        this->height_limit = SIZE_MAX;
+        this->height_limit_min_size = 0;
+        this->height_limit_max_size = SIZE_MAX;
+        return;
     }
+    double base = 1 / this->alpha;
+    this->height_limit = static_cast<size_t>(std::floor(std::log(this->node_count()) / std::log(base))) + 1;
+    this->height_limit_min_size = static_cast<size_t>(std::ceil(std::pow(base, this->height_limit - 1)));
+    this->height_limit_max_size = static_cast<size_t>(std::ceil(std::pow(base, this->height_limit)));
+}
+
+template <typename T, typename Allocator>
+void ScapegoatTree<T, Allocator>::remove(const T &value) {
+    if(this->adaptive_alpha) this->record_operation(true);
+    if(this->rebuild_job.shadow) this->advance_rebuild(true);
+    if(this->lazy_deletion) {
+        // Equal keys of a multiset may mix dead and live nodes, so take the first live one.
+        restricted_iterator it = this->find_lower_bound(value);
+        while(!it.get_node().is_end_node() && it.get_node().is_dead() && !(value < *it)) ++it;
+        if(it.get_node().is_end_node() || value < *it) return;
+        it.get_node().set_dead(true);
+        this->dead_count++;
+        this->filter_remove(value);
+        this->update_path(it.get_node());
+        this->record_update(value, false);
+        if(this->dead_count > this->max_dead_fraction * this->node_count()) this->request_rebuild();
+        return;
+    }
+    size_t count = this->node_count();
+    if(!this->access_counts.empty()) {
+        // A node with two children takes over its successor's value, so it takes over its count as well.
+        restricted_iterator it = this->lookup(value);
+        if(it != this->end() && it.get_node().has_left() && it.get_node().has_right()) {
+            size_t index = it.get_node().get_node_index();
+            size_t next = (++it).get_node().get_node_index();
+            if(this->access_counts.size() <= count) this->access_counts.resize(count + 1, 0);
+            this->access_counts[index] = this->access_counts[next];
+        }
+    }
+    BinarySearchTree<T, Allocator>::remove(value);
+    if(this->node_count() < count) this->record_update(value, false);
+    if(this->node_count() <= this->alpha * this->max_node_count) this->request_rebuild();
 }
 
 template class ScapegoatTree<int>;
@@ -198,4 +868,9 @@ template class ScapegoatTree<short>;
 template class ScapegoatTree<char>;
 template class ScapegoatTree<unsigned char>;
 
+namespace pmr {
+    template <typename T>
+    using ScapegoatTree = ::ScapegoatTree<T, std::pmr::polymorphic_allocator<T>>;
+}
+
 #endif //BINARY_SEARCH_TREES_SCAPEGOAT_H
\ No newline at end of file
@@ -0,0 +1,138 @@
+#ifndef BINARY_SEARCH_TREES_SPLAY_H
+#define BINARY_SEARCH_TREES_SPLAY_H
+
+#include "bst.h"
+#include <algorithm>
+
+enum class SplayMode {
+    full,       // classic bottom-up splay to the root
+    semi,       // semi-splay: zig-zig steps rotate only the parent, roughly halving the depth of the path
+};
+
+template <typename T, typename Allocator = std::allocator<T>>
+class SplayTree : public BinarySearchTree<T, Allocator> {
+public:
+    using iterator = typename SplayTree<T, Allocator>::iterator;
+    // find() restructures only on every `splay_period`-th hit, inserts and removals always splay.
+    explicit SplayTree(SplayMode mode = SplayMode::full, size_t splay_period = 1, const Allocator &allocator = Allocator());
+    explicit SplayTree(std::vector<T> values, SplayMode mode = SplayMode::full, size_t splay_period = 1,
+                       const Allocator &allocator = Allocator());
+    std::pair<iterator, bool> insert(const T &value) override;
+    iterator insert(iterator hint, const T &value) override;
+    void remove(const T &value) override;
+    iterator find(const T &value) override;
+
+private:
+    using Node = typename BinarySearchTree<T, Allocator>::Node;
+    using restricted_iterator = typename BinarySearchTree<T, Allocator>::restricted_iterator;
+    SplayMode mode;
+    size_t splay_period;
+    size_t access_count = 0;
+private:
+    void rotate_up(Node &node);
+    void splay(Node &node, SplayMode splay_mode);
+};
+
+template <typename T, typename Allocator>
+SplayTree<T, Allocator>::SplayTree(SplayMode mode, size_t splay_period, const Allocator &allocator)
+        : BinarySearchTree<T, Allocator>(allocator), mode(mode), splay_period(std::max<size_t>(splay_period, 1)) {}
+
+template <typename T, typename Allocator>
+SplayTree<T, Allocator>::SplayTree(std::vector<T> values, SplayMode mode, size_t splay_period, const Allocator &allocator)
+        : SplayTree(mode, splay_period, allocator) {
+    for(auto value : values) {
+        this->insert(value);
+    }
+}
+
+template <typename T, typename Allocator>
+void SplayTree<T, Allocator>::rotate_up(Node &node) {
+    Node &parent = node.parent();
+    Node &grandparent = parent.parent();
+    if(parent.is_left_sibling()) grandparent.set_left_index(node.get_node_index());
+    else grandparent.set_right_index(node.get_node_index());
+    if(node.is_left_sibling()) {
+        parent.set_left_index(node.get_right_index());
+        if(node.has_right()) node.right().set_parent_index(parent.get_node_index());
+        node.set_right_index(parent.get_node_index());
+    }
+    else {
+        parent.set_right_index(node.get_left_index());
+        if(node.has_left()) node.left().set_parent_index(parent.get_node_index());
+        node.set_left_index(parent.get_node_index());
+    }
+    node.set_parent_index(grandparent.get_node_index());
+    parent.set_parent_index(node.get_node_index());
+}
+
+template <typename T, typename Allocator>
+void SplayTree<T, Allocator>::splay(Node &node, SplayMode splay_mode) {
+    Node *node_ptr = &node;
+    while(!node_ptr->parent().is_end_node()) {
+        Node &parent = node_ptr->parent();
+        if(parent.parent().is_end_node()) {
+            this->rotate_up(*node_ptr);                         // zig
+        }
+        else if(node_ptr->is_left_sibling() == parent.is_left_sibling()) {
+            this->rotate_up(parent);                            // zig-zig
+            if(splay_mode == SplayMode::semi) node_ptr = &parent;
+            else this->rotate_up(*node_ptr);
+        }
+        else {
+            this->rotate_up(*node_ptr);                         // zig-zag
+            this->rotate_up(*node_ptr);
+        }
+    }
+}
+
+template <typename T, typename Allocator>
+typename SplayTree<T, Allocator>::iterator SplayTree<T, Allocator>::find(const T &value) {
+    if(this->filter_excludes(value)) return this->end();
+    restricted_iterator it = this->find_lower_bound(value);     // the first of equal keys, as in the base find()
+    if(it == this->end() || value < *it) return this->end();
+    if(++this->access_count % this->splay_period == 0) this->splay(it.get_node(), this->mode);
+    return it;
+}
+
+template <typename T, typename Allocator>
+std::pair<typename SplayTree<T, Allocator>::iterator, bool> SplayTree<T, Allocator>::insert(const T &value) {
+    auto [parent, left, exists] = this->find_insert_position(value);
+    if(exists) return {iterator(*parent), false};
+    Node &new_node = this->attach(*parent, left, value);
+    this->splay(new_node, SplayMode::full);
+    return {iterator(new_node), true};
+}
+
+template <typename T, typename Allocator>
+typename SplayTree<T, Allocator>::iterator SplayTree<T, Allocator>::insert(iterator hint, const T &value) {
+    auto [parent, left, exists] = this->find_insert_position(hint, value);
+    if(exists) return iterator(*parent);
+    Node &new_node = this->attach(*parent, left, value);
+    this->splay(new_node, SplayMode::full);
+    return iterator(new_node);
+}
+
+template <typename T, typename Allocator>
+void SplayTree<T, Allocator>::remove(const T &value) {
+    restricted_iterator it = this->lookup(value);
+    if(it == this->end()) return;
+    this->splay(it.get_node(), SplayMode::full);
+    BinarySearchTree<T, Allocator>::remove(value);
+}
+
+template class SplayTree<int>;
+template class SplayTree<float>;
+template class SplayTree<double>;
+template class SplayTree<unsigned int>;
+template class SplayTree<unsigned long long>;
+template class SplayTree<long long>;
+template class SplayTree<short>;
+template class SplayTree<char>;
+template class SplayTree<unsigned char>;
+
+namespace pmr {
+    template <typename T>
+    using SplayTree = ::SplayTree<T, std::pmr::polymorphic_allocator<T>>;
+}
+
+#endif //BINARY_SEARCH_TREES_SPLAY_H
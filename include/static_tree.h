@@ -0,0 +1,115 @@
+#ifndef BINARY_SEARCH_TREES_STATIC_TREE_H
+#define BINARY_SEARCH_TREES_STATIC_TREE_H
+
+#include "bst.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+
+// Immutable search tree over a key set known at compile time. Keys are kept twice: sorted, for iteration, and in
+// Eytzinger (BFS) order, so a lookup walks an implicit complete tree whose top levels share cache lines. Lookups
+// are branch-free and take bit_width(N) - 1 or bit_width(N) steps, depending on whether they end above the partly
+// filled last level; only when N + 1 is a power of two is the trip count the same for every key.
+template <typename T, size_t N>
+class StaticSearchTree {
+public:
+    using iterator = const T *;
+    constexpr explicit StaticSearchTree(const std::array<T, N> &keys);
+    [[nodiscard]] constexpr iterator find(const T &value) const;
+    [[nodiscard]] constexpr iterator predecessor_find(const T &value) const;
+    [[nodiscard]] constexpr iterator successor_find(const T &value) const;
+    [[nodiscard]] constexpr bool contains(const T &value) const;
+    [[nodiscard]] constexpr size_t size() const;
+    [[nodiscard]] constexpr iterator begin() const;
+    [[nodiscard]] constexpr iterator end() const;
+private:
+    std::array<T, N> sorted{};
+    std::array<T, N + 1> layout{};      // 1-based, layout[k] has children 2k and 2k + 1
+    std::array<size_t, N + 1> rank{};   // position of layout[k] in sorted
+private:
+    constexpr size_t fill(size_t k, size_t next);
+    [[nodiscard]] constexpr size_t lower_bound(const T &value) const;
+    [[nodiscard]] constexpr size_t upper_bound(const T &value) const;
+};
+
+template <typename T, size_t N>
+constexpr StaticSearchTree<T, N>::StaticSearchTree(const std::array<T, N> &keys) : sorted(keys) {
+    std::sort(this->sorted.begin(), this->sorted.end());
+    if(std::adjacent_find(this->sorted.begin(), this->sorted.end()) != this->sorted.end()) throw DuplicateElement();
+    this->fill(1, 0);
+}
+
+template <typename T, size_t N>
+constexpr size_t StaticSearchTree<T, N>::fill(size_t k, size_t next) {
+    if(k > N) return next;
+    next = this->fill(2 * k, next);
+    this->layout[k] = this->sorted[next];
+    this->rank[k] = next;
+    return this->fill(2 * k + 1, next + 1);
+}
+
+// Descends to a leaf, then strips the trailing right turns: what is left is the last node where the search
+// turned left, i.e. the first key >= value (0 when there is none).
+template <typename T, size_t N>
+constexpr size_t StaticSearchTree<T, N>::lower_bound(const T &value) const {
+    size_t k = 1;
+    while(k <= N) k = 2 * k + (this->layout[k] < value);
+    return k >> (std::countr_one(k) + 1);
+}
+
+template <typename T, size_t N>
+constexpr size_t StaticSearchTree<T, N>::upper_bound(const T &value) const {
+    size_t k = 1;
+    while(k <= N) k = 2 * k + !(value < this->layout[k]);
+    return k >> (std::countr_one(k) + 1);
+}
+
+template <typename T, size_t N>
+constexpr typename StaticSearchTree<T, N>::iterator StaticSearchTree<T, N>::find(const T &value) const {
+    size_t k = this->lower_bound(value);
+    if(k == 0 || value < this->layout[k]) return this->end();
+    return this->begin() + this->rank[k];
+}
+
+template <typename T, size_t N>
+constexpr typename StaticSearchTree<T, N>::iterator StaticSearchTree<T, N>::successor_find(const T &value) const {
+    size_t k = this->lower_bound(value);
+    if(k == 0) return this->end();
+    return this->begin() + this->rank[k];
+}
+
+template <typename T, size_t N>
+constexpr typename StaticSearchTree<T, N>::iterator StaticSearchTree<T, N>::predecessor_find(const T &value) const {
+    size_t k = this->upper_bound(value);
+    size_t position = k == 0 ? N : this->rank[k];
+    if(position == 0) return this->end();
+    return this->begin() + position - 1;
+}
+
+template <typename T, size_t N>
+constexpr bool StaticSearchTree<T, N>::contains(const T &value) const {
+    return this->find(value) != this->end();
+}
+
+template <typename T, size_t N>
+constexpr size_t StaticSearchTree<T, N>::size() const {
+    return N;
+}
+
+template <typename T, size_t N>
+constexpr typename StaticSearchTree<T, N>::iterator StaticSearchTree<T, N>::begin() const {
+    return this->sorted.data();
+}
+
+template <typename T, size_t N>
+constexpr typename StaticSearchTree<T, N>::iterator StaticSearchTree<T, N>::end() const {
+    return this->sorted.data() + N;
+}
+
+// Forces the sort and layout to happen during compilation; a duplicate key is a compile error.
+template <typename T, size_t N>
+consteval StaticSearchTree<T, N> make_static_tree(const std::array<T, N> &keys) {
+    return StaticSearchTree<T, N>(keys);
+}
+
+#endif //BINARY_SEARCH_TREES_STATIC_TREE_H
@@ -1,9 +1,22 @@
 #include <iostream>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <numeric>
 #include <random>
 #include "avl.h"
 #include "scapegoat.h"
+#include "redblack.h"
+#include "splay.h"
+#include "bplus.h"
+#include "static_tree.h"
+#include "journal.h"
+#include "elias_fano.h"
+#include "interval.h"
+#include "augmented.h"
+#include "disk.h"
+#include "balanced.h"
+#include "buffered.h"
 
 std::vector<std::vector<int>> prepare_vectors(const std::vector<int> &sizes)
 {
@@ -19,68 +32,750 @@ std::vector<std::vector<int>> prepare_vectors(const std::vector<int> &sizes)
     return vectors;
 }
 
-void test_trees(const std::vector<std::vector<int>> &vectors)
+std::string percentiles(std::vector<std::chrono::nanoseconds> &latencies)
+{
+    if (latencies.empty()) return "";
+    std::sort(latencies.begin(), latencies.end());
+    auto at = [&latencies](double q) { return latencies.at(static_cast<size_t>(q * (latencies.size() - 1))).count(); };
+    return " (p50 " + std::to_string(at(.5)) + "ns, p99 " + std::to_string(at(.99)) + "ns, p999 " +
+           std::to_string(at(.999)) + "ns, max " + std::to_string(latencies.back().count()) + "ns)";
+}
+
+template<typename Tree>
+void test_tree(const std::string &name, Tree &tree, const std::vector<int> &vector)
 {
     using namespace std::chrono;
 
+    std::vector<nanoseconds> latencies;
+    latencies.reserve(vector.size());
+    auto start = high_resolution_clock::now();
+    for (auto value: vector) {
+        auto op_start = high_resolution_clock::now();
+        tree.insert(value);
+        latencies.push_back(high_resolution_clock::now() - op_start);
+    }
+    auto end = high_resolution_clock::now();
+    auto time = duration_cast<milliseconds>(end - start);
+    std::cout << name << " insertion time for " << vector.size() << " elements: " << time << percentiles(latencies)
+              << std::endl;
+
+    size_t qty = vector.size() / 5;
+
+    start = high_resolution_clock::now();
+    for (size_t i = vector.size() - 1; i >= vector.size() - qty - 1; --i) {
+        if(*tree.find(vector.at(i)) != vector.at(i)) throw std::exception();
+    }
+    end = high_resolution_clock::now();
+    time = duration_cast<milliseconds>(end - start);
+    std::cout << name << " look-up time for " << vector.size() << " elements, " << qty << " look-ups: " << time
+              << std::endl;
+
+    latencies.clear();
+    start = high_resolution_clock::now();
+    for (size_t i = vector.size() - 1; i >= vector.size() - qty - 1; --i) {
+        auto op_start = high_resolution_clock::now();
+        tree.remove(vector.at(i));
+        latencies.push_back(high_resolution_clock::now() - op_start);
+    }
+    end = high_resolution_clock::now();
+    time = duration_cast<milliseconds>(end - start);
+    std::cout << name << " removal time for " << vector.size() << " elements, " << qty << " removals: " << time
+              << percentiles(latencies) << std::endl;
+}
+
+void test_trees(const std::vector<std::vector<int>> &vectors)
+{
     for (const auto &vector: vectors) {
-        auto start = high_resolution_clock::now();
-        AVLTree<int> avl_tree(vector);
-        auto end = high_resolution_clock::now();
-        auto time = duration_cast<milliseconds>(end - start);
-        std::cout << "AVL tree insertion time for " << vector.size() << " elements: " << time << std::endl;
+        AVLTree<int> avl_tree;
+        test_tree("AVL tree", avl_tree, vector);
+
+        ScapegoatTree<int> sg_tree(.5);
+        test_tree("Scapegoat tree", sg_tree, vector);
+
+        ScapegoatTree<int> adaptive_sg_tree(.5);
+        adaptive_sg_tree.enable_adaptive_alpha();
+        test_tree("Scapegoat tree (adaptive alpha)", adaptive_sg_tree, vector);
+
+        ScapegoatTree<int> lazy_sg_tree(.5);
+        lazy_sg_tree.enable_lazy_deletion();
+        test_tree("Scapegoat tree (lazy deletion)", lazy_sg_tree, vector);
+
+        RedBlackTree<int> rb_tree;
+        test_tree("Red-black tree", rb_tree, vector);
+
+        BPlusTree<int> bplus_tree;
+        test_tree("B+ tree", bplus_tree, vector);
+        std::cout<<"\n\n";
+    }
+}
+
+template<typename Tree>
+void test_sorted_append(const std::string &name, size_t qty)
+{
+    using namespace std::chrono;
+
+    Tree tree;
+    auto start = high_resolution_clock::now();
+    for (size_t i = 0; i < qty; ++i) {
+        tree.insert(static_cast<int>(i));
+    }
+    auto end = high_resolution_clock::now();
+    auto time = duration_cast<milliseconds>(end - start);
+    std::cout << name << " sorted insertion time for " << qty << " elements: " << time << std::endl;
+
+    Tree hinted_tree;
+    start = high_resolution_clock::now();
+    for (size_t i = 0; i < qty; ++i) {
+        hinted_tree.insert(hinted_tree.end(), static_cast<int>(i));
+    }
+    end = high_resolution_clock::now();
+    time = duration_cast<milliseconds>(end - start);
+    std::cout << name << " sorted hinted insertion time for " << qty << " elements: " << time << std::endl;
+}
+
+// Roughly 30% of the stream repeats a key already seen, as in dedup-heavy ingestion.
+template<typename Tree>
+void test_duplicates(const std::string &name, const std::vector<int> &vector, bool multiset)
+{
+    using namespace std::chrono;
+
+    std::mt19937 g(std::random_device{}());
+    std::vector<int> stream;
+    stream.reserve(vector.size() + vector.size() * 3 / 7);
+    for (auto value: vector) {
+        stream.push_back(value);
+        if (g() % 7 < 3) stream.push_back(stream.at(g() % stream.size()));
+    }
+
+    Tree tree;
+    if (multiset) tree.enable_multiset();
+    size_t inserted = 0;
+    auto start = high_resolution_clock::now();
+    for (auto value: stream) {
+        inserted += tree.insert(value).second;
+    }
+    auto end = high_resolution_clock::now();
+    auto time = duration_cast<milliseconds>(end - start);
+    std::cout << name << (multiset ? " (multiset)" : "") << " insertion time for " << stream.size()
+              << " keys with duplicates: " << time << " (" << inserted << " inserted)" << std::endl;
+}
+
+template<typename Tree>
+void test_scans(const std::string &name, const std::vector<int> &vector)
+{
+    using namespace std::chrono;
+
+    Tree tree(vector);
+    long long sum = 0;
+    auto start = high_resolution_clock::now();
+    for (auto it = tree.begin(); it != tree.end(); ++it) sum += *it;
+    auto end = high_resolution_clock::now();
+    std::cout << name << " iterator scan of " << tree.size() << " elements: " << duration_cast<milliseconds>(end - start)
+              << std::endl;
+
+    long long for_each_sum = 0;
+    start = high_resolution_clock::now();
+    tree.for_each([&for_each_sum](int value) { for_each_sum += value; });
+    end = high_resolution_clock::now();
+    if (for_each_sum != sum) throw std::exception();
+    std::cout << name << " for_each scan of " << tree.size() << " elements: " << duration_cast<milliseconds>(end - start)
+              << std::endl;
+
+    start = high_resolution_clock::now();
+    auto snapshot = tree.to_vector();
+    end = high_resolution_clock::now();
+    if (snapshot.size() != tree.size()) throw std::exception();
+    std::cout << name << " to_vector of " << tree.size() << " elements: " << duration_cast<milliseconds>(end - start)
+              << std::endl;
+
+    std::atomic<long long> parallel_sum = 0;
+    start = high_resolution_clock::now();
+    tree.parallel_for_each([&parallel_sum](int value) { parallel_sum.fetch_add(value, std::memory_order_relaxed); });
+    end = high_resolution_clock::now();
+    if (parallel_sum != sum) throw std::exception();
+    std::cout << name << " parallel_for_each scan of " << tree.size() << " elements: "
+              << duration_cast<milliseconds>(end - start) << std::endl;
+}
 
+void test_journal(const std::vector<int> &vector)
+{
+    using namespace std::chrono;
+
+    ScapegoatTree<int> tree;
+    auto start = high_resolution_clock::now();
+    for (auto value: vector) tree.insert(value);
+    auto end = high_resolution_clock::now();
+    std::cout << "Scapegoat tree in-memory insertion time for " << vector.size() << " elements: "
+              << duration_cast<milliseconds>(end - start) << std::endl;
+
+    auto directory = std::filesystem::temp_directory_path() / "binary_search_trees_journal";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    {
+        JournaledTree<ScapegoatTree<int>> journaled_tree(directory / "tree");
         start = high_resolution_clock::now();
-        ScapegoatTree<int> sg_tree(vector, .5);
+        for (auto value: vector) journaled_tree.insert(value);
+        journaled_tree.sync();
         end = high_resolution_clock::now();
-        time = duration_cast<milliseconds>(end - start);
-        std::cout << "Scapegoat tree insertion time for " << vector.size() << " elements: " << time << std::endl;
+        std::cout << "Scapegoat tree journaled insertion time for " << vector.size() << " elements: "
+                  << duration_cast<milliseconds>(end - start) << std::endl;
+    }
+    start = high_resolution_clock::now();
+    JournaledTree<ScapegoatTree<int>> recovered_tree(directory / "tree");
+    end = high_resolution_clock::now();
+    if (recovered_tree.size() != vector.size()) throw std::exception();
+    std::cout << "Scapegoat tree journal recovery time for " << vector.size() << " elements: "
+              << duration_cast<milliseconds>(end - start) << std::endl;
+    std::filesystem::remove_all(directory);
+}
+
+void test_compressed_index(const std::vector<int> &vector)
+{
+    using namespace std::chrono;
+
+    ScapegoatTree<unsigned int> tree;
+    for (auto value: vector) tree.insert(static_cast<unsigned int>(value));
+    auto start = high_resolution_clock::now();
+    EliasFanoSet<unsigned int> index(tree);
+    auto end = high_resolution_clock::now();
+    std::cout << "Elias-Fano index built from " << tree.size() << " elements in " << duration_cast<milliseconds>(end - start)
+              << ", " << index.size_in_bytes() * 8.0 / index.size() << " bits per key" << std::endl;
+
+    start = high_resolution_clock::now();
+    for (auto value: vector) {
+        if (*tree.find(static_cast<unsigned int>(value)) != static_cast<unsigned int>(value)) throw std::exception();
+    }
+    end = high_resolution_clock::now();
+    std::cout << "Scapegoat tree look-up time for " << vector.size() << " look-ups: "
+              << duration_cast<milliseconds>(end - start) << std::endl;
+
+    start = high_resolution_clock::now();
+    for (auto value: vector) {
+        if (!index.contains(static_cast<unsigned int>(value))) throw std::exception();
+    }
+    end = high_resolution_clock::now();
+    std::cout << "Elias-Fano index look-up time for " << vector.size() << " look-ups: "
+              << duration_cast<milliseconds>(end - start) << std::endl;
+}
+
+template<typename Tree>
+void test_filtered_misses(const std::string &name, const std::vector<int> &vector, double miss_fraction)
+{
+    using namespace std::chrono;
+
+    // Only even keys are stored, so odd queries miss after a full descent between present keys.
+    Tree tree;
+    for (auto value: vector) tree.insert(2 * value);
+    std::mt19937 g(std::random_device{}());
+    std::bernoulli_distribution miss(miss_fraction);
+    std::vector<int> queries(vector.size());
+    for (size_t i = 0; i < queries.size(); ++i) queries.at(i) = 2 * vector.at(i) + miss(g);
+
+    for (bool filtered: {false, true}) {
+        if (filtered) tree.enable_filter(.01);
+        size_t hits = 0;
+        auto start = high_resolution_clock::now();
+        for (auto query: queries) hits += tree.contains(query);
+        auto end = high_resolution_clock::now();
+        std::cout << name << (filtered ? " with" : " without") << " filter, " << miss_fraction * 100 << "% misses: "
+                  << duration_cast<milliseconds>(end - start) << " (" << hits << " hits";
+        if (filtered) std::cout << ", filter " << tree.filter_memory() / 1024 << " KiB";
+        std::cout << ")" << std::endl;
+    }
+}
 
-        size_t qty = vector.size() / 5;
+template<typename Tree>
+void test_finger_search(const std::string &name, const std::vector<int> &vector, int max_step)
+{
+    using namespace std::chrono;
+
+    Tree tree(vector);
+    std::mt19937 g(std::random_device{}());
+    std::uniform_int_distribution<int> step(-max_step, max_step);
+    std::vector<int> queries(vector.size());
+    int position = static_cast<int>(vector.size()) / 2;
+    for (auto &query: queries) {
+        position = std::clamp(position + step(g), 0, static_cast<int>(vector.size()) - 1);
+        query = position;
+    }
+
+    auto start = high_resolution_clock::now();
+    for (auto query: queries) {
+        if (*tree.find(query) != query) throw std::exception();
+    }
+    auto end = high_resolution_clock::now();
+    std::cout << name << " local look-ups (step <= " << max_step << ") from the root: "
+              << duration_cast<milliseconds>(end - start) << std::endl;
+
+    auto cursor = tree.cursor();
+    start = high_resolution_clock::now();
+    for (auto query: queries) {
+        if (*cursor.find(query) != query) throw std::exception();
+    }
+    end = high_resolution_clock::now();
+    std::cout << name << " local look-ups (step <= " << max_step << ") from a cursor: "
+              << duration_cast<milliseconds>(end - start) << std::endl;
+}
+
+void test_interval_queries(size_t qty, size_t queries)
+{
+    using namespace std::chrono;
+
+    std::mt19937 g(std::random_device{}());
+    std::uniform_int_distribution<int> start_distribution(0, 100000000);
+    std::uniform_int_distribution<int> length_distribution(0, 1000);
+    IntervalTree<int> tree;
+    for (size_t i = 0; i < qty; ++i) {
+        int low = start_distribution(g);
+        tree.insert({low, low + length_distribution(g)});
+    }
+    std::vector<int> points(queries);
+    for (auto &point: points) point = start_distribution(g);
+
+    size_t scan_hits = 0;
+    auto start = high_resolution_clock::now();
+    for (auto point: points) {
+        tree.for_each([&scan_hits, point](const Interval<int> &interval) { scan_hits += interval.overlaps(point, point); });
+    }
+    auto end = high_resolution_clock::now();
+    std::cout << "Interval tree full-scan stabbing time for " << tree.size() << " intervals, " << queries
+              << " queries: " << duration_cast<milliseconds>(end - start) << " (" << scan_hits << " hits)" << std::endl;
+
+    size_t hits = 0;
+    start = high_resolution_clock::now();
+    for (auto point: points) tree.stab(point, [&hits](const Interval<int> &) { hits++; });
+    end = high_resolution_clock::now();
+    if (hits != scan_hits) throw std::exception();
+    std::cout << "Interval tree stab() time for " << tree.size() << " intervals, " << queries << " queries: "
+              << duration_cast<milliseconds>(end - start) << " (" << hits << " hits)" << std::endl;
+}
+
+template<typename Tree>
+void test_range_aggregates(const std::string &name, const std::vector<int> &vector, size_t queries, int width)
+{
+    using namespace std::chrono;
+
+    AugmentedTree<Tree, SumMonoid<long long>> tree(vector);
+    std::mt19937 g(std::random_device{}());
+    std::uniform_int_distribution<int> distribution(0, static_cast<int>(vector.size()));
+    std::vector<int> lows(queries);
+    for (auto &low: lows) low = distribution(g);
+
+    long long iterated = 0;
+    auto start = high_resolution_clock::now();
+    for (auto low: lows) {
+        for (auto it = tree.successor_find(low); it != tree.end() && *it <= low + width; ++it) iterated += *it;
+    }
+    auto end = high_resolution_clock::now();
+    std::cout << name << " range sums over " << width << " keys by iteration, " << queries << " queries: "
+              << duration_cast<milliseconds>(end - start) << std::endl;
 
+    long long aggregated = 0;
+    start = high_resolution_clock::now();
+    for (auto low: lows) aggregated += tree.aggregate(low, low + width);
+    end = high_resolution_clock::now();
+    if (aggregated != iterated) throw std::exception();
+    std::cout << name << " range sums over " << width << " keys by aggregate(), " << queries << " queries: "
+              << duration_cast<milliseconds>(end - start) << std::endl;
+}
+
+template<typename Tree>
+void test_clone(const std::string &name, const std::vector<int> &vector)
+{
+    using namespace std::chrono;
+
+    auto start = high_resolution_clock::now();
+    Tree tree(vector);
+    auto end = high_resolution_clock::now();
+    std::cout << name << " build of " << tree.size() << " elements by insertion: "
+              << duration_cast<milliseconds>(end - start) << std::endl;
+
+    start = high_resolution_clock::now();
+    Tree copy(tree);
+    end = high_resolution_clock::now();
+    if (copy.size() != tree.size()) throw std::exception();
+    std::cout << name << " copy of " << tree.size() << " elements: " << duration_cast<microseconds>(end - start)
+              << std::endl;
+
+    start = high_resolution_clock::now();
+    Tree moved(std::move(copy));
+    end = high_resolution_clock::now();
+    if (moved.size() != tree.size()) throw std::exception();
+    std::cout << name << " move of " << tree.size() << " elements: " << duration_cast<microseconds>(end - start)
+              << std::endl;
+}
+
+template <typename Tree>
+void test_work_queue(const std::string &name, Tree tree, size_t operations)
+{
+    using namespace std::chrono;
+
+    size_t size = tree.size();
+    long long checksum = 0;
+    auto start = high_resolution_clock::now();
+    for (size_t i = 0; i < operations; ++i) checksum += tree.min() + tree.max();
+    auto end = high_resolution_clock::now();
+    std::cout << name << " " << operations << " min/max peeks: " << duration_cast<microseconds>(end - start)
+              << std::endl;
+
+    int next = tree.max();
+    start = high_resolution_clock::now();
+    for (size_t i = 0; i < operations; ++i) {
+        checksum += tree.pop_min();
+        tree.insert(tree.end(), ++next);
+    }
+    end = high_resolution_clock::now();
+    if (checksum == 0 || tree.size() != size) throw std::exception();
+    std::cout << name << " " << operations << " pop_min + append: " << duration_cast<milliseconds>(end - start)
+              << std::endl;
+}
+
+void test_parallel_rebuild(const std::vector<int> &vector, const std::vector<size_t> &thread_counts)
+{
+    using namespace std::chrono;
+
+    ScapegoatTree<int> tree(vector);
+    tree.enable_lazy_deletion(1);
+    for (size_t i = 0; i < vector.size(); i += 2) tree.remove(vector[i]);
+
+    for (size_t threads : thread_counts) {
+        ScapegoatTree<int> copy(tree);
+        if (threads > 1) copy.enable_parallel_rebuild(1 << 16, threads);
+        auto start = high_resolution_clock::now();
+        copy.disable_lazy_deletion();
+        auto end = high_resolution_clock::now();
+        if (copy.size() != tree.size()) throw std::exception();
+        std::cout << "Scapegoat tree full rebuild of " << vector.size() << " nodes on " << threads << " thread(s): "
+                  << duration_cast<milliseconds>(end - start) << std::endl;
+    }
+}
+
+std::vector<int> prepare_zipfian_queries(const std::vector<int> &keys, size_t qty, double skew)
+{
+    std::random_device rd;
+    std::mt19937 g(rd());
+    std::vector<double> cdf(keys.size());
+    double sum = 0;
+    for (size_t rank = 0; rank < keys.size(); ++rank) {
+        sum += 1 / std::pow(static_cast<double>(rank + 1), skew);
+        cdf.at(rank) = sum;
+    }
+    std::uniform_real_distribution<double> distribution(0, sum);
+    std::vector<int> queries(qty);
+    for (auto &query: queries) {
+        auto rank = std::lower_bound(cdf.begin(), cdf.end(), distribution(g)) - cdf.begin();
+        query = keys.at(std::min<size_t>(rank, keys.size() - 1));
+    }
+    return queries;
+}
+
+template<typename Tree>
+void test_lookups(const std::string &name, Tree &tree, const std::vector<int> &queries, double skew)
+{
+    using namespace std::chrono;
+
+    auto start = high_resolution_clock::now();
+    for (auto query: queries) {
+        if(*tree.find(query) != query) throw std::exception();
+    }
+    auto end = high_resolution_clock::now();
+    auto time = duration_cast<milliseconds>(end - start);
+    std::cout << name << " zipfian (s = " << skew << ") look-up time for " << tree.size() << " elements, "
+              << queries.size() << " look-ups: " << time << std::endl;
+}
+
+void test_zipfian(const std::vector<int> &keys, size_t qty, const std::vector<double> &skews)
+{
+    AVLTree<int> avl_tree(keys);
+    SplayTree<int> splay_tree(keys);
+    SplayTree<int> semi_splay_tree(keys, SplayMode::semi);
+    SplayTree<int> periodic_splay_tree(keys, SplayMode::full, 8);
+
+    for (auto skew: skews) {
+        auto queries = prepare_zipfian_queries(keys, qty, skew);
+        test_lookups("AVL tree", avl_tree, queries, skew);
+        test_lookups("Splay tree", splay_tree, queries, skew);
+        test_lookups("Semi-splay tree", semi_splay_tree, queries, skew);
+        test_lookups("Splay tree (every 8th access)", periodic_splay_tree, queries, skew);
+        std::cout<<"\n";
+    }
+}
+
+void test_weighted_layout(const std::vector<int> &keys, size_t qty, const std::vector<double> &skews)
+{
+    AVLTree<int> avl_tree(keys);
+    ScapegoatTree<int> scapegoat_tree(keys);
+
+    for (auto skew: skews) {
+        auto queries = prepare_zipfian_queries(keys, qty, skew);
+        scapegoat_tree.disable_access_counting();
+        scapegoat_tree.rebuild_by_weight();
+        scapegoat_tree.enable_access_counting(16);
+        test_lookups("AVL tree", avl_tree, queries, skew);
+        test_lookups("Scapegoat tree (balanced, counting)", scapegoat_tree, queries, skew);
+        scapegoat_tree.rebuild_by_weight();
+        test_lookups("Scapegoat tree (weighted)", scapegoat_tree, queries, skew);
+        std::cout<<"\n";
+    }
+}
+
+// Fixed protocol-id style key set, laid out at compile time.
+constexpr auto static_keys = make_static_tree(std::array<short, 31>{
+        443, 80, 22, 25, 53, 110, 143, 993, 995, 587, 21, 23, 3306, 5432, 6379, 8080,
+        8443, 11211, 27017, 9200, 5672, 1883, 123, 161, 389, 636, 3389, 5900, 179, 514, 873});
+static_assert(static_keys.contains(443) && !static_keys.contains(444));
+static_assert(*static_keys.successor_find(444) == 514 && *static_keys.predecessor_find(444) == 443);
+
+void test_static_lookups(size_t qty)
+{
+    using namespace std::chrono;
+
+    AVLTree<short> avl_tree(std::vector<short>(static_keys.begin(), static_keys.end()));
+    std::mt19937 g(std::random_device{}());
+    std::uniform_int_distribution<short> distribution(0, 30000);
+    std::vector<short> queries(qty);
+    for (auto &query: queries) query = distribution(g);
+
+    size_t hits = 0;
+    auto start = high_resolution_clock::now();
+    for (auto query: queries) hits += avl_tree.find(query) != avl_tree.end();
+    auto end = high_resolution_clock::now();
+    auto time = duration_cast<milliseconds>(end - start);
+    std::cout << "AVL tree look-up time for " << avl_tree.size() << " fixed keys, " << qty << " look-ups: " << time
+              << " (" << hits << " hits)" << std::endl;
+
+    hits = 0;
+    start = high_resolution_clock::now();
+    for (auto query: queries) hits += static_keys.contains(query);
+    end = high_resolution_clock::now();
+    time = duration_cast<milliseconds>(end - start);
+    std::cout << "Static tree look-up time for " << static_keys.size() << " fixed keys, " << qty << " look-ups: "
+              << time << " (" << hits << " hits)" << std::endl;
+}
+
+template<typename Tree, typename... TreeArgs>
+void test_buffered_inserts(const std::string &name, const std::vector<int> &vector, const std::vector<size_t> &capacities,
+                           TreeArgs... tree_args)
+{
+    using namespace std::chrono;
+
+    Tree tree(tree_args...);
+    auto start = high_resolution_clock::now();
+    for (auto value: vector) tree.insert(value);
+    auto end = high_resolution_clock::now();
+    std::cout << name << " unbuffered insertion time for " << vector.size() << " elements: "
+              << duration_cast<milliseconds>(end - start) << std::endl;
+
+    for (auto capacity: capacities) {
+        BufferedTree<Tree> buffered_tree(capacity, tree_args...);
         start = high_resolution_clock::now();
-        for (size_t i = vector.size() - 1; i >= vector.size() - qty - 1; --i) {
-            if(*avl_tree.find(vector.at(i)) != vector.at(i)) throw std::exception();
-        }
+        for (auto value: vector) buffered_tree.insert(value);
+        buffered_tree.flush();
         end = high_resolution_clock::now();
-        time = duration_cast<milliseconds>(end - start);
-        std::cout << "AVL tree look-up time for " << vector.size() << " elements, " << qty << " look-ups: " << time
+        if (buffered_tree.size() != tree.size()) throw std::exception();
+        std::cout << name << " insertion time for " << vector.size() << " elements through a " << capacity
+                  << " key write buffer: " << duration_cast<milliseconds>(end - start) << std::endl;
+    }
+}
+
+void test_insert_latency(const std::string &name, const std::vector<int> &vector, bool incremental)
+{
+    using namespace std::chrono;
+
+    ScapegoatTree<int> tree;
+    if (incremental) tree.enable_incremental_rebuild();
+    std::vector<long long> latencies(vector.size());
+    size_t max_depth = 0;
+    auto start = steady_clock::now();
+    for (size_t i = 0; i < vector.size(); i++) {
+        auto before = steady_clock::now();
+        tree.insert(vector[i]);
+        latencies[i] = duration_cast<nanoseconds>(steady_clock::now() - before).count();
+        if (tree.is_rebuilding()) max_depth = std::max(max_depth, tree.depth(vector[i]));
+    }
+    auto total = duration_cast<milliseconds>(steady_clock::now() - start);
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * static_cast<double>(latencies.size())))];
+    };
+    std::cout << "Scapegoat tree (" << (incremental ? "incremental" : "synchronous") << " rebuilds) " << name
+              << " insertion of " << vector.size() << " elements: " << total << ", p50 " << percentile(.5)
+              << "ns, p99 " << percentile(.99) << "ns, p999 " << percentile(.999) << "ns, max "
+              << latencies.back() / 1000 << "us";
+    if (incremental) std::cout << ", max depth during rebuilds " << max_depth;
+    std::cout << std::endl;
+}
+
+template<typename Tree>
+void test_dispatch(const std::string &name, const std::vector<int> &vector, size_t qty)
+{
+    using namespace std::chrono;
+
+    std::mt19937 g(std::random_device{}());
+    std::uniform_int_distribution<size_t> distribution(0, vector.size() - 1);
+    std::vector<int> queries(qty);
+    for (auto &query: queries) query = vector[distribution(g)];
+
+    Tree static_tree;
+    auto start = high_resolution_clock::now();
+    for (auto value: vector) static_tree.insert(value);
+    auto end = high_resolution_clock::now();
+    std::cout << name << " static dispatch insertion time for " << vector.size() << " elements: "
+              << duration_cast<milliseconds>(end - start) << std::endl;
+
+    Tree tree;
+    BinarySearchTree<int> &dynamic_tree = tree;
+    start = high_resolution_clock::now();
+    for (auto value: vector) dynamic_tree.insert(value);
+    end = high_resolution_clock::now();
+    std::cout << name << " virtual dispatch insertion time for " << vector.size() << " elements: "
+              << duration_cast<milliseconds>(end - start) << std::endl;
+
+    size_t hits = 0;
+    start = high_resolution_clock::now();
+    for (auto query: queries) hits += static_tree.contains(query);
+    end = high_resolution_clock::now();
+    std::cout << name << " static dispatch look-up time for " << qty << " look-ups: "
+              << duration_cast<milliseconds>(end - start) << " (" << hits << " hits)" << std::endl;
+
+    hits = 0;
+    start = high_resolution_clock::now();
+    for (auto query: queries) hits += dynamic_tree.contains(query);
+    end = high_resolution_clock::now();
+    std::cout << name << " virtual dispatch look-up time for " << qty << " look-ups: "
+              << duration_cast<milliseconds>(end - start) << " (" << hits << " hits)" << std::endl;
+}
+
+void test_disk_tree(const std::vector<int> &vector, const std::vector<size_t> &budgets)
+{
+    using namespace std::chrono;
+
+    auto path = std::filesystem::temp_directory_path() / "binary_search_trees_disk_tree";
+    auto report = [](const std::string &what, const DiskTree<int> &tree, size_t operations, milliseconds time) {
+        std::cout << "  " << what << ": " << time << ", "
+                  << static_cast<double>(tree.stats().page_misses) / static_cast<double>(operations)
+                  << " page misses / op, "
+                  << static_cast<double>(tree.stats().page_fetches) / static_cast<double>(operations)
+                  << " page fetches / op" << std::endl;
+    };
+    for (auto budget: budgets) {
+        DiskTreeOptions options;
+        options.memory_budget = budget;
+        DiskTree<int> tree(path, options);
+        std::cout << "Disk tree, " << (budget >> 10) << " KiB buffer pool, " << vector.size() << " elements:"
                   << std::endl;
 
+        auto start = high_resolution_clock::now();
+        for (auto value: vector) tree.insert(value);
+        auto end = high_resolution_clock::now();
+        report("insertion", tree, vector.size(), duration_cast<milliseconds>(end - start));
+
+        tree.reset_stats();
         start = high_resolution_clock::now();
-        for (size_t i = vector.size() - 1; i >= vector.size() - qty - 1; --i) {
-            if(*sg_tree.find(vector.at(i)) != vector.at(i)) throw std::exception();
-        }
+        for (auto value: vector) if (tree.find(value) == tree.end()) throw std::exception();
         end = high_resolution_clock::now();
-        time = duration_cast<milliseconds>(end - start);
-        std::cout << "Scapegoat tree look-up time for " << vector.size() << " elements, " << qty << " look-ups: "
-                  << time << std::endl;
+        report("look-up", tree, vector.size(), duration_cast<milliseconds>(end - start));
 
+        tree.compact();
+        tree.reset_stats();
         start = high_resolution_clock::now();
-        for (size_t i = vector.size() - 1; i >= vector.size() - qty - 1; --i) {
-            avl_tree.remove(vector.at(i));
-        }
+        for (auto value: vector) if (tree.find(value) == tree.end()) throw std::exception();
         end = high_resolution_clock::now();
-        time = duration_cast<milliseconds>(end - start);
-        std::cout << "AVL tree removal time for " << vector.size() << " elements, " << qty << " removals: " << time
-                  << std::endl;
+        report("look-up after compact()", tree, vector.size(), duration_cast<milliseconds>(end - start));
 
+        tree.reset_stats();
+        size_t visited = 0;
         start = high_resolution_clock::now();
-        for (size_t i = vector.size() - 1; i >= vector.size() - qty - 1; --i) {
-            sg_tree.remove(vector.at(i));
-        }
+        for (auto it = tree.begin(); it != tree.end(); ++it) visited++;
         end = high_resolution_clock::now();
-        time = duration_cast<milliseconds>(end - start);
-        std::cout << "Scapegoat tree removal time for " << vector.size() << " elements, " << qty << " removals: "
-                  << time << std::endl;
-        std::cout<<"\n\n";
+        if (visited != tree.size()) throw std::exception();
+        report("in-order scan", tree, visited, duration_cast<milliseconds>(end - start));
     }
 }
 
+// Removing a suffix of the keys leaves dead nodes behind the last live one; rebuilds have to reclaim their slots.
+void test_disk_tree_churn(int count, int rounds)
+{
+    using namespace std::chrono;
+
+    DiskTree<int> tree(std::filesystem::temp_directory_path() / "binary_search_trees_disk_churn");
+    for (int i = 0; i < count; i++) tree.insert(i);
+    for (int round = 0; round < rounds; round++) {
+        for (int i = count * 4 / 10; i < count; i++) tree.remove(i);
+        auto start = high_resolution_clock::now();
+        for (int i = count * 4 / 10; i < count; i++) tree.insert(i);
+        auto end = high_resolution_clock::now();
+        if (tree.slot_count() > 2 * tree.size() + 1024) throw std::exception();
+        std::cout << "Disk tree churn round " << round << ": reinsertion of the top 60% of " << count << " keys: "
+                  << duration_cast<milliseconds>(end - start) << ", " << tree.slot_count() << " slots for "
+                  << tree.size() << " keys" << std::endl;
+    }
+    for (int i = 0; i < count; i++) tree.remove(i);
+    if (tree.slot_count() != 0) throw std::exception();
+}
+
 int main() {
     std::vector<int> sizes = {1000, 10000, 100000, 500000, 1000000, 10000000};
     auto test_vectors = prepare_vectors(sizes);
     test_trees(test_vectors);
+    test_sorted_append<AVLTree<int>>("AVL tree", 100000);
+    test_sorted_append<ScapegoatTree<int>>("Scapegoat tree", 100000);
+    test_sorted_append<RedBlackTree<int>>("Red-black tree", 100000);
+    std::cout<<"\n";
+    test_duplicates<AVLTree<int>>("AVL tree", test_vectors.at(3), false);
+    test_duplicates<AVLTree<int>>("AVL tree", test_vectors.at(3), true);
+    test_duplicates<ScapegoatTree<int>>("Scapegoat tree", test_vectors.at(3), false);
+    test_duplicates<ScapegoatTree<int>>("Scapegoat tree", test_vectors.at(3), true);
+    std::cout<<"\n";
+    test_scans<ScapegoatTree<int>>("Scapegoat tree", test_vectors.at(4));
+    std::cout<<"\n";
+    test_journal(test_vectors.at(3));
+    std::cout<<"\n";
+    test_compressed_index(test_vectors.at(4));
+    std::cout<<"\n";
+    test_filtered_misses<ScapegoatTree<int>>("Scapegoat tree", test_vectors.at(4), .9);
+    test_filtered_misses<RedBlackTree<int>>("Red-black tree", test_vectors.at(4), .9);
+    std::cout<<"\n";
+    test_finger_search<AVLTree<int>>("AVL tree", test_vectors.at(3), 16);
+    test_finger_search<ScapegoatTree<int>>("Scapegoat tree", test_vectors.at(4), 16);
+    test_finger_search<ScapegoatTree<int>>("Scapegoat tree", test_vectors.at(4), 4096);
+    std::cout<<"\n";
+    test_interval_queries(100000, 1000);
+    std::cout<<"\n";
+    test_range_aggregates<AVLTree<int>>("AVL tree", test_vectors.at(3), 1000, 10000);
+    test_range_aggregates<ScapegoatTree<int>>("Scapegoat tree", test_vectors.at(4), 1000, 10000);
+    std::cout<<"\n";
+    test_clone<AVLTree<int>>("AVL tree", test_vectors.at(3));
+    test_clone<ScapegoatTree<int>>("Scapegoat tree", test_vectors.at(4));
+    test_clone<RedBlackTree<int>>("Red-black tree", test_vectors.at(4));
+    std::cout<<"\n";
+    test_parallel_rebuild(test_vectors.at(4), {1, 2, 4, std::thread::hardware_concurrency()});
+    std::cout<<"\n";
+    test_work_queue("AVL tree", AVLTree<int>(test_vectors.at(3)), 1000000);
+    test_work_queue("Scapegoat tree (alpha 0.7)", ScapegoatTree<int>(test_vectors.at(3), .7), 1000000);
+    test_work_queue("Red-black tree", RedBlackTree<int>(test_vectors.at(3)), 1000000);
+    test_work_queue("Splay tree", SplayTree<int>(test_vectors.at(3)), 1000000);
+    std::cout<<"\n";
+    test_zipfian(test_vectors.at(4), 5000000, {.5, .8, .99, 1.2});
+    test_weighted_layout(test_vectors.at(4), 5000000, {.8, .99, 1.2});
+    test_static_lookups(10000000);
+    std::cout<<"\n";
+    test_disk_tree(test_vectors.at(4), {1 << 20, 16 << 20, 64 << 20});
+    test_disk_tree_churn(20000, 4);
+    std::cout<<"\n";
+    test_dispatch<BalancedTree<int, AVLPolicy>>("AVL tree", test_vectors.at(4), 5000000);
+    test_dispatch<BalancedTree<int, ScapegoatPolicy>>("Scapegoat tree", test_vectors.at(4), 5000000);
+    test_dispatch<BalancedTree<int, RedBlackPolicy>>("Red-black tree", test_vectors.at(4), 5000000);
+    std::cout<<"\n";
+    std::vector<int> ascending(200000);
+    std::iota(ascending.begin(), ascending.end(), 0);
+    for (bool incremental: {false, true}) {
+        test_insert_latency("random", test_vectors.at(4), incremental);
+        test_insert_latency("ascending", ascending, incremental);
+    }
+    std::cout<<"\n";
+    test_buffered_inserts<AVLTree<int>>("AVL tree", test_vectors.at(4), {256, 4096});
+    test_buffered_inserts<ScapegoatTree<int>>("Scapegoat tree (alpha .7)", test_vectors.at(4), {256, 4096}, .7);
 
     /*
      * Descoperiri: